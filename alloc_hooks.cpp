@@ -0,0 +1,104 @@
+#include "alloc_tracker.h"
+
+#include <cstdlib>
+#include <new>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+// replacement of global operators new and delete which counts allocations in alloc_tracker
+// this file is not a part of approximator_lib, it is linked only to executables which need counting
+
+namespace {
+void* Allocate(std::size_t size) {
+    alloc::RecordAllocation(size);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void Deallocate(void* ptr) {
+    if (ptr) {
+        alloc::RecordDeallocation();
+        std::free(ptr);
+    }
+}
+
+// over-aligned types (alignas greater than the alignment of malloc) are allocated by these
+void* AllocateAligned(std::size_t size, std::align_val_t align) {
+    alloc::RecordAllocation(size);
+    const auto alignment = static_cast<std::size_t>(align);
+#ifdef _MSC_VER
+    void* ptr = _aligned_malloc(size ? size : 1, alignment);
+#else
+    // the size of aligned_alloc must be a multiple of the alignment
+    const std::size_t aligned_size = ((size ? size : 1) + alignment - 1) / alignment * alignment;
+    void* ptr = std::aligned_alloc(alignment, aligned_size);
+#endif
+    if (ptr) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void DeallocateAligned(void* ptr) {
+    if (ptr) {
+        alloc::RecordDeallocation();
+#ifdef _MSC_VER
+        _aligned_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+}
+}  // namespace
+
+void* operator new(std::size_t size) {
+    return Allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return Allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    Deallocate(ptr);
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    return AllocateAligned(size, align);
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return AllocateAligned(size, align);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    DeallocateAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    DeallocateAligned(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    DeallocateAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    DeallocateAligned(ptr);
+}
@@ -0,0 +1,168 @@
+#include "alloc_tracker.h"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+
+namespace alloc {
+
+using namespace std::literals;
+
+namespace {
+
+const size_t MAX_STAGES = 64;
+const size_t OTHER_STAGE = 0;
+
+// counter written only by the owner thread, so it doesn't need atomic increments
+class Counter {
+public:
+    void Add(uint64_t value) {
+        value_.store(value_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    uint64_t Get() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+struct StageCounters {
+    Counter allocations;
+    Counter bytes;
+    Counter deallocations;
+};
+
+// counters of one thread, allocated with malloc because they are created inside operator new
+// they are never freed, so totals keep allocations of finished threads
+struct ThreadCounters {
+    std::array<StageCounters, MAX_STAGES> stages;
+    ThreadCounters* next = nullptr;
+};
+
+std::atomic<ThreadCounters*> threads_head{nullptr};
+
+std::mutex stages_mutex;
+std::array<const char*, MAX_STAGES> stage_names{"other"};
+std::atomic<size_t> stages_count{1};
+
+thread_local ThreadCounters* thread_counters = nullptr;
+thread_local size_t current_stage = OTHER_STAGE;
+
+ThreadCounters* GetThreadCounters() {
+    if (!thread_counters) {
+        void* memory = std::malloc(sizeof(ThreadCounters));
+        if (!memory) {
+            return nullptr;
+        }
+        auto* counters = new (memory) ThreadCounters();
+        counters->next = threads_head.load(std::memory_order_relaxed);
+        while (!threads_head.compare_exchange_weak(counters->next, counters, std::memory_order_release,
+                                                   std::memory_order_relaxed)) {
+        }
+        thread_counters = counters;
+    }
+    return thread_counters;
+}
+
+Stats ToStats(const StageCounters& counters) {
+    return {counters.allocations.Get(), counters.bytes.Get(), counters.deallocations.Get()};
+}
+
+void AddStats(Stats& lhs, const Stats& rhs) {
+    lhs.allocations += rhs.allocations;
+    lhs.bytes += rhs.bytes;
+    lhs.deallocations += rhs.deallocations;
+}
+
+Stats GetThreadTotal(const ThreadCounters& counters) {
+    Stats stats;
+    for (const StageCounters& stage : counters.stages) {
+        AddStats(stats, ToStats(stage));
+    }
+    return stats;
+}
+
+}  // namespace
+
+void RecordAllocation(size_t size) {
+    if (ThreadCounters* counters = GetThreadCounters()) {
+        StageCounters& stage = counters->stages[current_stage];
+        stage.allocations.Add(1);
+        stage.bytes.Add(size);
+    }
+}
+
+void RecordDeallocation() {
+    if (ThreadCounters* counters = GetThreadCounters()) {
+        counters->stages[current_stage].deallocations.Add(1);
+    }
+}
+
+Stats GetThreadStats() {
+    return thread_counters ? GetThreadTotal(*thread_counters) : Stats{};
+}
+
+Stats GetTotalStats() {
+    Stats stats;
+    for (auto* counters = threads_head.load(std::memory_order_acquire); counters; counters = counters->next) {
+        AddStats(stats, GetThreadTotal(*counters));
+    }
+    return stats;
+}
+
+std::vector<StageStats> GetStageStats() {
+    const size_t count = stages_count.load(std::memory_order_acquire);
+    std::vector<StageStats> stages(count);
+    for (size_t i = 0; i < count; ++i) {
+        stages[i].name = stage_names[i];
+    }
+    for (auto* counters = threads_head.load(std::memory_order_acquire); counters; counters = counters->next) {
+        for (size_t i = 0; i < count; ++i) {
+            AddStats(stages[i].stats, ToStats(counters->stages[i]));
+        }
+    }
+    return stages;
+}
+
+size_t RegisterStage(const char* name) {
+    std::lock_guard lock(stages_mutex);
+    const size_t count = stages_count.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        if (std::strcmp(stage_names[i], name) == 0) {
+            return i;
+        }
+    }
+    if (count == MAX_STAGES) {
+        return OTHER_STAGE;
+    }
+    stage_names[count] = name;
+    stages_count.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+ScopedStage::ScopedStage(size_t stage_id) : prev_stage_id_{current_stage} {
+    current_stage = stage_id < MAX_STAGES ? stage_id : OTHER_STAGE;
+}
+
+ScopedStage::~ScopedStage() {
+    current_stage = prev_stage_id_;
+}
+
+void WriteSummary(std::ostream& out) {
+    out << std::left << std::setw(40) << "allocation stage"sv << std::right
+        << std::setw(14) << "allocations"sv << std::setw(16) << "bytes"sv
+        << std::setw(16) << "deallocations"sv << '\n';
+    for (const StageStats& stage : GetStageStats()) {
+        out << std::left << std::setw(40) << stage.name << std::right
+            << std::setw(14) << stage.stats.allocations
+            << std::setw(16) << stage.stats.bytes
+            << std::setw(16) << stage.stats.deallocations << '\n';
+    }
+}
+
+}  // namespace alloc
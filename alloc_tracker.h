@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+// accounting of heap allocations by threads and by named stages of the pipeline
+// counting starts when alloc_hooks.cpp (replacement of global operator new and delete) is linked:
+// approximator_bench always links it, approximator links it with -DAPPROXIMATOR_ALLOC_TRACKING=ON
+// macro ALLOC_STAGE is compiled out unless APPROXIMATOR_ALLOC_TRACKING is defined
+namespace alloc {
+
+constexpr bool IsEnabled() {
+#ifdef APPROXIMATOR_ALLOC_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+struct Stats {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;  // allocated bytes
+    uint64_t deallocations = 0;
+};
+
+struct StageStats {
+    std::string_view name;
+    Stats stats;
+};
+
+// called by the replaced operators new and delete, must not allocate
+void RecordAllocation(size_t size);
+void RecordDeallocation();
+
+// allocations of the current thread
+Stats GetThreadStats();
+// allocations of all threads
+Stats GetTotalStats();
+// allocations of all threads by stages, allocations outside of stages are in the "other" stage
+std::vector<StageStats> GetStageStats();
+
+// returns id of the stage with the name, name must be a string literal
+// the number of stages is limited, extra stages are counted as "other"
+size_t RegisterStage(const char* name);
+
+// allocations of the current thread are counted to the stage until destruction
+// nested stages take allocations from outer ones
+class ScopedStage {
+public:
+    explicit ScopedStage(size_t stage_id);
+
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+
+    ~ScopedStage();
+
+private:
+    size_t prev_stage_id_;
+};
+
+// writes table with allocations and bytes of every stage
+void WriteSummary(std::ostream& out);
+
+}  // namespace alloc
+
+#ifdef APPROXIMATOR_ALLOC_TRACKING
+#define ALLOC_CONCAT_IMPL(lhs, rhs) lhs##rhs
+#define ALLOC_CONCAT(lhs, rhs) ALLOC_CONCAT_IMPL(lhs, rhs)
+#define ALLOC_STAGE(name) \
+    static const size_t ALLOC_CONCAT(alloc_stage_id_, __LINE__) = ::alloc::RegisterStage(name); \
+    ::alloc::ScopedStage ALLOC_CONCAT(alloc_stage_, __LINE__)(ALLOC_CONCAT(alloc_stage_id_, __LINE__))
+#else
+#define ALLOC_STAGE(name) static_cast<void>(0)
+#endif
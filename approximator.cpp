@@ -1,4 +1,9 @@
 #include "approximator.h"
+#include "alloc_tracker.h"
+#include "data_reducer.h"
+#include "fit_report.h"
+#include "gram_basis.h"
+#include "profiler.h"
 
 #include <algorithm>
 #include <cassert>
@@ -21,16 +26,18 @@ namespace {
 // x[0]^2n x[1]^2n ... x[m-1]^2*max_power
 // m - numbers of x
 // n - max power
-Matrix GetXPowers(const std::vector<Data>& data, int max_power) {
+template <typename Accum, typename T>
+BasicMatrix<Accum> GetXPowers(const std::vector<BasicData<T>>& data, int max_power) {
+    PROFILE_SCOPE("GetXPowers");
     // matrix with x powers
     const size_t size = 2 * max_power; // powers from 1 to 2*max_power
-    std::vector<std::vector<double>> x_powers(size);
+    BasicMatrix<Accum> x_powers(size);
     
     for(size_t i = 0; i < size; ++i) {
         x_powers[i].reserve(data.size()); // x[0] to x[m-1]
 
         for(size_t j = 0; j < data.size(); ++j) {
-            double prev_x_power = i > 0 ? x_powers[i-1][j] : 1;
+            Accum prev_x_power = i > 0 ? x_powers[i-1][j] : 1;
             x_powers[i].emplace_back(prev_x_power * data[j].x);
         }
     }
@@ -39,18 +46,17 @@ Matrix GetXPowers(const std::vector<Data>& data, int max_power) {
 
 // return vector with sum of powers of each x[i]:
 // m sum(x[i]) sum(x[i]^2) ... sum(x[i]^2n)
-std::vector<double> GetSumOfXPowers(const Matrix& x_powers, int max_power) {
-    if (x_powers.empty()) {
-        return {};
-    }
-    std::vector<double> sum_x_powers;
+// x_powers is empty for max_power 0, so the number of points m is passed apart
+template <typename Accum>
+std::vector<Accum> GetSumOfXPowers(const BasicMatrix<Accum>& x_powers, size_t points_count, int max_power) {
+    std::vector<Accum> sum_x_powers;
     sum_x_powers.reserve(2 * max_power + 1);
 
-    sum_x_powers.emplace_back(x_powers[0].size());
+    sum_x_powers.emplace_back(points_count);
 
     std::for_each(x_powers.begin(), x_powers.end(),
-        [&sum_x_powers](const std::vector<double>& vec) {
-            sum_x_powers.emplace_back(std::accumulate(vec.begin(), vec.end(), 0.0));
+        [&sum_x_powers](const std::vector<Accum>& vec) {
+            sum_x_powers.emplace_back(std::accumulate(vec.begin(), vec.end(), Accum{0}));
     });
     return sum_x_powers;
 }
@@ -64,56 +70,280 @@ std::vector<double> GetSumOfXPowers(const Matrix& x_powers, int max_power) {
 | sum(x^(n-1)) sum(x^n) ... sum(x^2n-2)   sum(x^(2n-1)) |   | sum(x^n-1*y) |
 | sum(x^n) sum(x^(n+1)) ... sum(x^(2n-1)) sum(x^2n)     |   | sum(x^n*y)   |
 */
-Matrix GetMatrix(const Matrix& x_powers, int max_power) {
-    std::vector<double> sum_x_powers = GetSumOfXPowers(x_powers, max_power);
+// the sums are accumulated in Accum and rounded to T
+template <typename T, typename Accum>
+BasicMatrix<T> GetMatrix(const BasicMatrix<Accum>& x_powers, size_t points_count, int max_power) {
+    std::vector<Accum> sum_x_powers = GetSumOfXPowers(x_powers, points_count, max_power);
     const size_t size = max_power + 1;
-    Matrix matrix(size); // matrix
+    BasicMatrix<T> matrix(size); // matrix
 
     for(size_t i = 0; i < size; ++i) {
-        matrix[i] = std::vector<double>(size);
+        matrix[i] = std::vector<T>(size);
         for(size_t j = 0; j < size; ++j) { // fill cols
-            matrix[i][j] = sum_x_powers[i + j];
+            matrix[i][j] = static_cast<T>(sum_x_powers[i + j]);
         }
     }
     return matrix;
 }
 
-std::vector<double> GetRightPart(const Matrix& x_powers, const std::vector<Data>& data, int max_power) {
-    std::vector<double> right_part(max_power + 1);
+// the sums are accumulated in Accum and rounded to R
+// the sum of y^2 is collected in the pass of the sum of y if sum_yy is given
+template <typename R, typename T, typename Accum>
+std::vector<R> GetRightPart(const BasicMatrix<Accum>& x_powers, const std::vector<BasicData<T>>& data, int max_power,
+                            long double* sum_yy = nullptr) {
+    std::vector<R> right_part(max_power + 1);
 
-    right_part[0] = std::accumulate(data.begin(), data.end(), 0,
-        [](double init, Data data) {
-            return init + data.y;
-    });
+    if (sum_yy) {
+        Accum sum_y = 0;
+        long double sum_y_squares = 0;
+        for (const BasicData<T>& point : data) {
+            sum_y += point.y;
+            sum_y_squares += static_cast<long double>(point.y) * point.y;
+        }
+        right_part[0] = static_cast<R>(sum_y);
+        *sum_yy = sum_y_squares;
+    } else {
+        right_part[0] = static_cast<R>(std::accumulate(data.begin(), data.end(), Accum{0},
+            [](Accum init, BasicData<T> data) {
+                return init + data.y;
+        }));
+    }
     
     for (size_t i = 1; i < right_part.size(); ++i) {
-        double res = 0;
+        Accum res = 0;
         for (size_t j = 0; j < data.size(); ++j) {
             res += x_powers[i - 1][j] * data[j].y;
         }
-        right_part[i] = res;
+        right_part[i] = static_cast<R>(res);
     }
     return right_part;
 }
 
-EquationSystem GetEquationSystem(const std::vector<Data>& data, int max_power) {
-    const auto x_powers = GetXPowers(data, max_power);
-    return EquationSystem(GetMatrix(x_powers, max_power), GetRightPart(x_powers, data, max_power));
+// sums of w * x^k for k up to 2 * max_power and of w * x^k * y for k up to max_power in one pass,
+// the sum of w * y^2 is collected too if sum_yy is given
+template <typename Accum, typename T>
+void AccumulateWeightedSums(const std::vector<BasicData<T>>& data, const std::vector<T>& weights, int max_power,
+                            std::vector<Accum>& sum_x_powers, std::vector<Accum>& right_part,
+                            long double* sum_yy = nullptr) {
+    const size_t size = max_power + 1;
+    sum_x_powers.assign(2 * size - 1, Accum{0});
+    right_part.assign(size, Accum{0});
+    long double sum_y_squares = 0;
+
+    for (size_t i = 0; i < data.size(); ++i) {
+        Accum weighted_power = weights[i];  // w * x^k
+        for (size_t k = 0; k < sum_x_powers.size(); ++k) {
+            sum_x_powers[k] += weighted_power;
+            if (k < size) {
+                right_part[k] += weighted_power * data[i].y;
+            }
+            weighted_power *= data[i].x;
+        }
+        if (sum_yy) {
+            sum_y_squares += static_cast<long double>(weights[i]) * data[i].y * data[i].y;
+        }
+    }
+    if (sum_yy) {
+        *sum_yy = sum_y_squares;
+    }
+}
+
+// returns the matrix of the system from sums of x powers rounded to T
+template <typename T, typename Accum>
+BasicMatrix<T> GetMatrixOfSums(const std::vector<Accum>& sum_x_powers, size_t size) {
+    BasicMatrix<T> matrix(size, std::vector<T>(size));
+    for (size_t i = 0; i < size; ++i) {
+        for (size_t j = 0; j < size; ++j) {
+            matrix[i][j] = static_cast<T>(sum_x_powers[i + j]);
+        }
+    }
+    return matrix;
+}
+
+// returns the matrix with elements rounded to T
+template <typename T>
+BasicMatrix<T> RoundMatrix(const BasicMatrix<long double>& matrix) {
+    BasicMatrix<T> res(matrix.size());
+    for (size_t i = 0; i < matrix.size(); ++i) {
+        res[i].assign(matrix[i].begin(), matrix[i].end());
+    }
+    return res;
 }
 
 }  // namespace
 
+// returns the system of equations of least squares method for the polynomial of max_power degree
+template <typename T, typename Accum>
+BasicEquationSystem<T> GetEquationSystem(const std::vector<BasicData<T>>& data, int max_power) {
+    PROFILE_SCOPE("GetEquationSystem");
+    ALLOC_STAGE("fit/equation system");
+    PROFILE_COUNTER("points", data.size());
+    const auto x_powers = GetXPowers<Accum>(data, max_power);
+    return BasicEquationSystem<T>(GetMatrix<T>(x_powers, data.size(), max_power), GetRightPart<T>(x_powers, data, max_power));
+}
+
+// returns the sums of the system of least squares and the sum of y^2
+template <typename T, typename Accum>
+BasicMoments<T> GetMoments(const std::vector<BasicData<T>>& data, int max_power) {
+    PROFILE_SCOPE("GetMoments");
+    ALLOC_STAGE("fit/equation system");
+    PROFILE_COUNTER("points", data.size());
+    const auto x_powers = GetXPowers<Accum>(data, max_power);
+    BasicMoments<T> moments;
+    moments.exact_matrix = GetMatrix<long double>(x_powers, data.size(), max_power);
+    moments.exact_right_part = GetRightPart<long double>(x_powers, data, max_power, &moments.sum_yy);
+    moments.matrix = RoundMatrix<T>(moments.exact_matrix);
+    moments.right_part.assign(moments.exact_right_part.begin(), moments.exact_right_part.end());
+    moments.count = data.size();
+    return moments;
+}
+
+// returns the system of weighted least squares: sums of w * x^k and w * x^k * y
+template <typename T>
+BasicEquationSystem<T> GetWeightedEquationSystem(const std::vector<BasicData<T>>& data,
+                                                 const std::vector<T>& weights, int max_power) {
+    PROFILE_SCOPE("GetWeightedEquationSystem");
+    ALLOC_STAGE("fit/equation system");
+    PROFILE_COUNTER("points", data.size());
+    std::vector<T> sum_x_powers;
+    std::vector<T> right_part;
+    AccumulateWeightedSums(data, weights, max_power, sum_x_powers, right_part);
+    return BasicEquationSystem<T>(GetMatrixOfSums<T>(sum_x_powers, right_part.size()), std::move(right_part));
+}
+
+// returns the sums of the system of weighted least squares and the sum of w * y^2
+template <typename T, typename Accum>
+BasicMoments<T> GetWeightedMoments(const std::vector<BasicData<T>>& data, const std::vector<T>& weights,
+                                   int max_power) {
+    PROFILE_SCOPE("GetWeightedMoments");
+    ALLOC_STAGE("fit/equation system");
+    PROFILE_COUNTER("points", data.size());
+    std::vector<Accum> sum_x_powers;
+    std::vector<Accum> right_part;
+    BasicMoments<T> moments;
+    AccumulateWeightedSums(data, weights, max_power, sum_x_powers, right_part, &moments.sum_yy);
+    moments.exact_matrix = GetMatrixOfSums<long double>(sum_x_powers, right_part.size());
+    moments.exact_right_part.assign(right_part.begin(), right_part.end());
+    moments.matrix = RoundMatrix<T>(moments.exact_matrix);
+    moments.right_part.assign(right_part.begin(), right_part.end());
+    moments.count = data.size();
+    return moments;
+}
+
+// returns count points of the polynomial evenly spaced from min_x to max_x
+template <typename T>
+std::vector<BasicData<T>> GeneratePoints(const BasicPolynomial<T>& polynom, std::type_identity_t<T> min_x,
+                                         std::type_identity_t<T> max_x, size_t count) {
+    std::vector<BasicData<T>> points(count);
+
+    const T step = (max_x - min_x) / (count - 1);
+    T next = min_x;
+
+    for (BasicData<T>& point : points) {
+        point.x = next;
+        point.y = polynom(point.x);
+        next += step;
+    }
+    return points;
+}
+
+// returns min and max x of the data, the data must not be empty
+template <typename T>
+std::pair<T, T> GetRangeX(const std::vector<BasicData<T>>& data) {
+    const auto [iter_min, iter_max] = std::minmax_element(data.begin(), data.end(),
+        [](BasicData<T> lhs, BasicData<T> rhs) {
+            return lhs.x < rhs.x;
+    });
+    return {iter_min->x, iter_max->x};
+}
+
+// returns sum of squared errors of the polynomial on the data
+template <typename T>
+T GetSumSquaredErrors(const BasicPolynomial<T>& polynom, const std::vector<BasicData<T>>& data) {
+    return std::accumulate(data.begin(), data.end(), T{0},
+        [&polynom](T init, BasicData<T> point) {
+            const T error = point.y - polynom(point.x);
+            return init + error * error;
+    });
+}
+
+// returns half-widths of the confidence band of the polynomial values at x of the points
+template <typename T>
+std::vector<T> GetConfidenceBand(const BasicMatrix<T>& covariance, const std::vector<BasicData<T>>& points, T z) {
+    const size_t size = covariance.size();
+    std::vector<T> band;
+    band.reserve(points.size());
+
+    std::vector<T> phi(size);
+    for (const BasicData<T>& point : points) {
+        T x_power = 1;
+        for (T& value : phi) {
+            value = x_power;
+            x_power *= point.x;
+        }
+        T variance = 0;
+        for (size_t i = 0; i < size; ++i) {
+            T row_sum = 0;
+            for (size_t j = 0; j < size; ++j) {
+                row_sum += covariance[i][j] * phi[j];
+            }
+            variance += phi[i] * row_sum;
+        }
+        // rounding errors can make the variance slightly negative
+        band.push_back(z * std::sqrt(std::max(variance, T{0})));
+    }
+    return band;
+}
+
 // sets the data to be approximated
-void Approximator::SetData(std::vector<Data>& data) {
+template <typename T, typename Accum>
+void BasicApproximator<T, Accum>::SetData(std::vector<DataType>& data) {
     data_ = std::move(data);
+    weights_.clear();
+    spread_ = 0;
+    polynom_.reset();
+    refined_solution_.reset();
+    moments_.reset();
+}
+
+// sets the points merged into weighted points
+template <typename T, typename Accum>
+void BasicApproximator<T, Accum>::SetData(BasicReducedData<T> data) {
+    data_ = std::move(data.points);
+    weights_ = std::move(data.weights);
+    spread_ = data.spread;
+    reduced_count_ = data.count;
+    polynom_.reset();
+    refined_solution_.reset();
+    moments_.reset();
+}
+
+// sets the method of solving the system, resets the calculated polynomial
+template <typename T, typename Accum>
+void BasicApproximator<T, Accum>::SetSolveMode(SolveMode mode) {
+    solve_mode_ = mode;
+    polynom_.reset();
+    refined_solution_.reset();
+    moments_.reset();
+}
+
+// sets the use of Gram polynomials for the uniform grid, resets the calculated polynomial
+template <typename T, typename Accum>
+void BasicApproximator<T, Accum>::SetGridMode(GridMode mode) {
+    grid_mode_ = mode;
+    polynom_.reset();
+    refined_solution_.reset();
+    moments_.reset();
 }
 
 // returns coefficients of the polynomial
-Polynomial Approximator::GetPolynom() const {
+template <typename T, typename Accum>
+auto BasicApproximator<T, Accum>::GetPolynom() const -> PolynomialType {
     return polynom_.value();
 }
 // returns coefficients of the polynomial
-std::optional<Polynomial> Approximator::GetPolynom(size_t polynom_degree) {
+template <typename T, typename Accum>
+auto BasicApproximator<T, Accum>::GetPolynom(size_t polynom_degree) -> std::optional<PolynomialType> {
     if (polynom_ && polynom_degree_ == polynom_degree) {
         return polynom_;
     }
@@ -123,25 +353,195 @@ std::optional<Polynomial> Approximator::GetPolynom(size_t polynom_degree) {
     return polynom_;
 }
 
+// returns the last calculated polynomial if it exists
+template <typename T, typename Accum>
+auto BasicApproximator<T, Accum>::GetLastPolynom() const -> const std::optional<PolynomialType>& {
+    return polynom_;
+}
+
 // method calculate polynomial coefficient for data_ and set polynom_coeff_
-void Approximator::CalcPolynomCoeffs() {
-    auto res = GetEquationSystem(data_, polynom_degree_).GetSolve();
+template <typename T, typename Accum>
+void BasicApproximator<T, Accum>::CalcPolynomCoeffs() {
+    ALLOC_STAGE("fit");
+    refined_solution_.reset();
+    moments_.reset();
+
+    const bool uniform = weights_.empty() && data_.size() > polynom_degree_
+        && (grid_mode_ == GridMode::UNIFORM || (grid_mode_ == GridMode::AUTO && IsUniformGrid(data_)));
+    if (uniform) {
+        if (!gram_basis_ || gram_basis_->GetPointsCount() != data_.size()
+                || gram_basis_->GetDegree() != polynom_degree_) {
+            gram_basis_ = std::make_shared<GramBasis<T>>(data_.size(), polynom_degree_);
+        }
+        polynom_ = gram_basis_->Fit(data_);
+        return;
+    }
+
+    if (weights_.empty()) {
+        moments_ = GetMoments<T, Accum>(data_, polynom_degree_);
+    } else {
+        // the sums of the groups are the sums of their points, y^2 also has the spread inside the groups
+        moments_ = GetWeightedMoments<T, Accum>(data_, weights_, polynom_degree_);
+        moments_->sum_yy += spread_;
+        moments_->count = reduced_count_;
+    }
+    const BasicEquationSystem<T> system(moments_->matrix, moments_->right_part);
+    if (solve_mode_ == SolveMode::REFINED) {
+        refined_solution_ = system.GetRefinedSolve(moments_->exact_matrix, moments_->exact_right_part);
+        if (refined_solution_) {
+            polynom_ = PolynomialType(refined_solution_->solution);
+        }
+        return;
+    }
+    auto res = system.GetSolve();
     if (res) {
-        polynom_ = Polynomial(res.value());
+        polynom_ = PolynomialType(res.value());
     }
 }
 
+// returns iterations and condition number of the last solve in REFINED mode
+template <typename T, typename Accum>
+auto BasicApproximator<T, Accum>::GetRefinedSolution() const -> const std::optional<RefinedSolution<T>>& {
+    return refined_solution_;
+}
+
 // return sum of squared errors
-double Approximator::GetSumSquaredErrors() const {
+template <typename T, typename Accum>
+T BasicApproximator<T, Accum>::GetSumSquaredErrors() const {
     if (!polynom_) {
         return 0;
     }
-    return std::accumulate(data_.begin(), data_.end(), 0,
-        [this](double init, Data point) {
-            return init + pow(point.y - (*polynom_)(point.x), 2);
-    });
+    if (weights_.empty()) {
+        return ::GetSumSquaredErrors(*polynom_, data_);
+    }
+    long double sse = spread_;
+    for (size_t i = 0; i < data_.size(); ++i) {
+        const T error = data_[i].y - (*polynom_)(data_[i].x);
+        sse += static_cast<long double>(weights_[i]) * error * error;
+    }
+    return static_cast<T>(sse);
+}
+
+// returns diagnostics of the last polynomial
+template <typename T, typename Accum>
+std::optional<BasicFitReport<T>> BasicApproximator<T, Accum>::GetFitReport(ReportMode mode,
+                                                                           size_t histogram_bins) const {
+    if (!polynom_) {
+        return std::nullopt;
+    }
+    std::optional<BasicFitReport<T>> report;
+    if (moments_) {
+        report = ::GetFitReport(*moments_, *polynom_);
+    }
+    if (mode == ReportMode::MOMENTS && report) {
+        return report;
+    }
+    if (!weights_.empty()) {
+        // the pass over the groups gives the exact SSE, the points themselves are not kept
+        const long double sse = GetSumSquaredErrors();
+        const long double count = static_cast<long double>(GetPointsCount());
+        const long double sum_y = moments_ ? moments_->right_part[0] : 0;
+        const long double total = moments_ ? moments_->sum_yy - sum_y * sum_y / count : 0;
+        BasicFitReport<T> weighted_report;
+        weighted_report.points_count = GetPointsCount();
+        weighted_report.sse = static_cast<T>(sse);
+        weighted_report.r_squared = total > 0 ? static_cast<T>(1 - sse / total) : (sse == 0 ? T{1} : T{0});
+        weighted_report.rmse = static_cast<T>(std::sqrt(sse / count));
+        return weighted_report;
+    }
+    // the rmse from the moments scales the histogram, so the residuals are binned in the same pass
+    return ::GetFitReport(*polynom_, data_, histogram_bins, report ? report->rmse : T{0});
+}
+
+// returns covariance matrix of the coefficients of the last polynomial
+template <typename T, typename Accum>
+std::optional<BasicMatrix<T>> BasicApproximator<T, Accum>::GetCovariance() const {
+    if (!polynom_ || GetPointsCount() <= polynom_->coeffs.size()) {
+        return std::nullopt;
+    }
+    return GetCovariance(GetFitReport(ReportMode::DATA_PASS)->sse);
 }
 
-std::vector<Data> Approximator::GetData() const {
+template <typename T, typename Accum>
+std::optional<BasicMatrix<T>> BasicApproximator<T, Accum>::GetCovariance(T sse) const {
+    if (!polynom_ || GetPointsCount() <= polynom_->coeffs.size()) {
+        return std::nullopt;
+    }
+
+    BasicMatrix<T> covariance;
+    if (refined_solution_) {
+        covariance = refined_solution_->inverse;
+    } else {
+        // the sums of the fit are reused if they are known
+        BasicMatrix<T> matrix = moments_ ? moments_->matrix
+            : GetEquationSystem<T, Accum>(data_, static_cast<int>(polynom_->coeffs.size() - 1)).GetMatrix();
+        const auto lu = LuFactorization<T>::Factor(std::move(matrix));
+        if (!lu) {
+            return std::nullopt;
+        }
+        covariance = lu->GetInverse();
+    }
+
+    const T variance = sse / static_cast<T>(GetPointsCount() - polynom_->coeffs.size());
+    // the inverse of the symmetric matrix is symmetric only up to rounding, so the mean of the halves is taken
+    for (size_t i = 0; i < covariance.size(); ++i) {
+        covariance[i][i] *= variance;
+        for (size_t j = i + 1; j < covariance.size(); ++j) {
+            const T value = (covariance[i][j] + covariance[j][i]) / 2 * variance;
+            covariance[i][j] = value;
+            covariance[j][i] = value;
+        }
+    }
+    return covariance;
+}
+
+template <typename T, typename Accum>
+size_t BasicApproximator<T, Accum>::GetPointsCount() const {
+    return weights_.empty() ? data_.size() : reduced_count_;
+}
+
+template <typename T, typename Accum>
+auto BasicApproximator<T, Accum>::GetData() const -> std::vector<DataType> {
     return data_;
-}
\ No newline at end of file
+}
+
+#define INSTANTIATE_APPROXIMATOR(T, Accum) \
+    template BasicEquationSystem<T> GetEquationSystem<T, Accum>(const std::vector<BasicData<T>>&, int); \
+    template BasicMoments<T> GetMoments<T, Accum>(const std::vector<BasicData<T>>&, int); \
+    template BasicMoments<T> GetWeightedMoments<T, Accum>(const std::vector<BasicData<T>>&, \
+                                                          const std::vector<T>&, int); \
+    template class BasicApproximator<T, Accum>
+
+template std::vector<float> GetConfidenceBand<float>(const BasicMatrix<float>&,
+                                                     const std::vector<BasicData<float>>&, float);
+template std::vector<double> GetConfidenceBand<double>(const BasicMatrix<double>&,
+                                                       const std::vector<BasicData<double>>&, double);
+template std::vector<long double> GetConfidenceBand<long double>(const BasicMatrix<long double>&,
+                                                                 const std::vector<BasicData<long double>>&, long double);
+
+template BasicEquationSystem<float> GetWeightedEquationSystem<float>(const std::vector<BasicData<float>>&,
+                                                                     const std::vector<float>&, int);
+template BasicEquationSystem<double> GetWeightedEquationSystem<double>(const std::vector<BasicData<double>>&,
+                                                                       const std::vector<double>&, int);
+template BasicEquationSystem<long double> GetWeightedEquationSystem<long double>(
+    const std::vector<BasicData<long double>>&, const std::vector<long double>&, int);
+
+template std::vector<BasicData<float>> GeneratePoints<float>(const BasicPolynomial<float>&, float, float, size_t);
+template std::vector<BasicData<double>> GeneratePoints<double>(const BasicPolynomial<double>&, double, double, size_t);
+template std::vector<BasicData<long double>> GeneratePoints<long double>(const BasicPolynomial<long double>&,
+                                                                          long double, long double, size_t);
+
+template std::pair<float, float> GetRangeX<float>(const std::vector<BasicData<float>>&);
+template std::pair<double, double> GetRangeX<double>(const std::vector<BasicData<double>>&);
+template std::pair<long double, long double> GetRangeX<long double>(const std::vector<BasicData<long double>>&);
+
+template float GetSumSquaredErrors<float>(const BasicPolynomial<float>&, const std::vector<BasicData<float>>&);
+template double GetSumSquaredErrors<double>(const BasicPolynomial<double>&, const std::vector<BasicData<double>>&);
+template long double GetSumSquaredErrors<long double>(const BasicPolynomial<long double>&,
+                                                      const std::vector<BasicData<long double>>&);
+
+INSTANTIATE_APPROXIMATOR(float, float);
+INSTANTIATE_APPROXIMATOR(double, double);
+INSTANTIATE_APPROXIMATOR(long double, long double);
+INSTANTIATE_APPROXIMATOR(float, double);
+INSTANTIATE_APPROXIMATOR(double, long double);
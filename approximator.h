@@ -3,62 +3,226 @@
 #include "equation_system.h"
 
 #include <cmath>
+#include <memory>
 #include <numeric>
 #include <optional>
+#include <type_traits>
+#include <utility>
+
+// all templates are explicitly instantiated in approximator.cpp
+// for float, double and long double and for the mixed modes listed below
 
 using Coeffs = std::vector<double>;
 
 // pairs of x and y(x) that needs to approximate
-struct Data {
-    double x;
-    double y;
+template <typename T>
+struct BasicData {
+    T x;
+    T y;
 };
 
-struct Polynomial {
+using Data = BasicData<double>;
+
+// converts points to the other precision
+template <typename T, typename U>
+std::vector<BasicData<T>> ConvertData(const std::vector<BasicData<U>>& data) {
+    std::vector<BasicData<T>> res;
+    res.reserve(data.size());
+    for (const BasicData<U>& point : data) {
+        res.push_back({static_cast<T>(point.x), static_cast<T>(point.y)});
+    }
+    return res;
+}
+
+template <typename T>
+struct BasicPolynomial {
 public:
-    explicit Polynomial(std::vector<double> vec) : coeffs{std::move(vec)} {}
-    // calc polynomial func value y(x)
+    explicit BasicPolynomial(std::vector<T> vec) : coeffs{std::move(vec)} {}
+    // converts coefficients of the polynomial of the other precision
+    template <typename U>
+    explicit BasicPolynomial(const BasicPolynomial<U>& other) : coeffs(other.coeffs.begin(), other.coeffs.end()) {}
+
+    // calc polynomial func value y(x) by Horner's method, the cost is one multiply-add per coefficient
     // coeffs_ must contain values
-    double operator()(double x) const {
-        int exp = 0;
-        return std::accumulate(coeffs.begin(), coeffs.end(), 0.0,
-        [&x, &exp](double init, double value) {
-            double res = init + value * pow(x, exp);
-            ++exp;
-            return res;
+    T operator()(T x) const {
+        return std::accumulate(coeffs.rbegin(), coeffs.rend(), T{0},
+        [&x](T init, T value) {
+            return init * x + value;
     });
     }
 
     // coefficients in a polynomial, starts from the free member and ends on biggest degree member
-    std::vector<double> coeffs;
+    std::vector<T> coeffs;
+};
+
+using Polynomial = BasicPolynomial<double>;
+
+// returns the system of equations of least squares method for the polynomial of max_power degree
+// sums of x powers and of products with y are accumulated in Accum and then rounded to T
+template <typename T, typename Accum = T>
+BasicEquationSystem<T> GetEquationSystem(const std::vector<BasicData<T>>& data, int max_power);
+
+// sums of the least squares fit which are enough for diagnostics without the data, see fit_report.h
+template <typename T>
+struct BasicMoments {
+    BasicMatrix<T> matrix;  // sums of x^(i + j)
+    std::vector<T> right_part;  // sums of x^i * y
+    // the same sums before they were rounded to T, the refined solve computes its residuals with them
+    BasicMatrix<long double> exact_matrix;
+    std::vector<long double> exact_right_part;
+    long double sum_yy = 0;  // sum of y^2
+    size_t count = 0;  // number of points
+};
+
+// returns the sums of the system of least squares for the polynomial of max_power degree and the sum of y^2,
+// which is collected in the same pass as the sum of y
+template <typename T, typename Accum = T>
+BasicMoments<T> GetMoments(const std::vector<BasicData<T>>& data, int max_power);
+
+// returns the system of weighted least squares: sums of w * x^k and w * x^k * y
+// the sums are accumulated in one pass over the data, weights has a weight per point
+template <typename T>
+BasicEquationSystem<T> GetWeightedEquationSystem(const std::vector<BasicData<T>>& data,
+                                                 const std::vector<T>& weights, int max_power);
+
+// returns the sums of the system of weighted least squares and the sum of w * y^2 in one pass over the data,
+// count is the number of points, the sums are accumulated in Accum and rounded to T
+template <typename T, typename Accum = T>
+BasicMoments<T> GetWeightedMoments(const std::vector<BasicData<T>>& data, const std::vector<T>& weights, int max_power);
+
+// returns count points of the polynomial evenly spaced from min_x to max_x
+template <typename T>
+std::vector<BasicData<T>> GeneratePoints(const BasicPolynomial<T>& polynom, std::type_identity_t<T> min_x,
+                                         std::type_identity_t<T> max_x, size_t count);
+
+// returns min and max x of the data, the data must not be empty
+template <typename T>
+std::pair<T, T> GetRangeX(const std::vector<BasicData<T>>& data);
+
+// returns sum of squared errors of the polynomial on the data
+template <typename T>
+T GetSumSquaredErrors(const BasicPolynomial<T>& polynom, const std::vector<BasicData<T>>& data);
+
+// method of solving the system of least squares
+enum class SolveMode {
+    GAUSS,  // Gauss elimination without pivoting, the check of the determinant costs O(n!)
+    REFINED  // LU decomposition with partial pivoting and iterative refinement of the solution, the default
+};
+
+// returns half-widths of the confidence band of the polynomial values at x of the points:
+// z * sqrt(phi^T * covariance * phi), phi = (1, x, ..., x^n), costs O(n^2) per point
+template <typename T>
+std::vector<T> GetConfidenceBand(const BasicMatrix<T>& covariance, const std::vector<BasicData<T>>& points, T z);
+
+// use of the fast path for data on the uniform grid of x, see gram_basis.h
+enum class GridMode {
+    GENERAL,  // always build and solve the system of equations
+    AUTO,  // fit by Gram polynomials if x are uniformly spaced
+    UNIFORM  // the data is declared to be on the uniform grid sorted by x
 };
 
-class Approximator {
+template <typename T>
+class GramBasis;
+
+template <typename T>
+struct BasicFitReport;
+
+template <typename T>
+struct BasicReducedData;
+
+// source of fit diagnostics
+enum class ReportMode {
+    // from the sums of the fit if they are known and SSE is not lost in their rounding, costs O(n^2),
+    // SSE is approximate: it may differ from the pass over the data in the last digits kept by the rounding bound
+    MOMENTS,
+    DATA_PASS  // by one pass over the data, exact SSE, also finds the max residual and the histogram of residuals
+};
+
+// T is the type of the data, of the polynomial and of the system solution
+// Accum is the type in which the system is accumulated, it may be wider than T:
+// rounding errors of long sums then don't grow with the number of points
+template <typename T, typename Accum = T>
+class BasicApproximator {
 public:
-    Approximator() = default;
+    using DataType = BasicData<T>;
+    using PolynomialType = BasicPolynomial<T>;
 
-    // sets the data to be approximated
-    void SetData(std::vector<Data>& data);
+    BasicApproximator() = default;
+
+    // sets the data to be approximated, resets the calculated polynomial
+    void SetData(std::vector<DataType>& data);
+    // sets the points merged into weighted points, see data_reducer.h, resets the calculated polynomial
+    // the fit, SSE and the covariance are of the points before the reduction,
+    // the fast path of the uniform grid is not used
+    void SetData(BasicReducedData<T> data);
+    // sets the method of solving the system, resets the calculated polynomial
+    void SetSolveMode(SolveMode mode);
+    // sets the use of Gram polynomials for the uniform grid, resets the calculated polynomial
+    void SetGridMode(GridMode mode);
 
     // returns coefficients of the polynomial if the approximation is successful
     // the coefficients follow starting from a0 to an
-    Polynomial GetPolynom() const;
+    PolynomialType GetPolynom() const;
     // returns coefficients of the polynomial
-    std::optional<Polynomial> GetPolynom(size_t polynom_degree);
+    std::optional<PolynomialType> GetPolynom(size_t polynom_degree);
+    // returns the last calculated polynomial if it exists
+    const std::optional<PolynomialType>& GetLastPolynom() const;
     
+    // returns iterations and condition number of the last solve in REFINED mode
+    const std::optional<RefinedSolution<T>>& GetRefinedSolution() const;
+
     // return sum of squared errors
-    double GetSumSquaredErrors() const;
+    T GetSumSquaredErrors() const;
 
-    std::vector<Data> GetData() const;
+    // returns covariance matrix of the coefficients of the last polynomial: SSE / (m - n - 1) * (X^T * X)^-1
+    // the inverse matrix is taken from the factorization, costs O(n^3)
+    // returns nullopt if there is no polynomial or the number of points is not greater than the number of coefficients
+    std::optional<BasicMatrix<T>> GetCovariance() const;
+    // the same with SSE of the last polynomial already known to the caller, e.g. from GetFitReport
+    std::optional<BasicMatrix<T>> GetCovariance(T sse) const;
+
+    // returns SSE, R^2, RMSE of the last polynomial and in DATA_PASS mode the max residual
+    // and the histogram of histogram_bins bins, see fit_report.h
+    // MOMENTS mode falls back to the pass over the data on the uniform grid fast path
+    // for the reduced data the pass is over the groups, so the report has no max residual and histogram
+    // returns nullopt if there is no polynomial
+    std::optional<BasicFitReport<T>> GetFitReport(ReportMode mode = ReportMode::DATA_PASS,
+                                                  size_t histogram_bins = 0) const;
+
+    // returns the data, for the reduced data returns the points of the groups
+    std::vector<DataType> GetData() const;
+    // returns the number of points, for the reduced data the number of points before the reduction
+    size_t GetPointsCount() const;
 
 private:
     // method calculate polynomial coefficient for data_ and set polynom_coeff_
     void CalcPolynomCoeffs();
 
     // data that needs to be approximated
-    std::vector<Data> data_{};
+    std::vector<DataType> data_{};
+    // weights of the reduced data, empty if the data is not reduced
+    std::vector<T> weights_;
+    // spread of y inside the groups of the reduced data and the number of points before the reduction
+    long double spread_ = 0;
+    size_t reduced_count_ = 0;
     // degree of polynomial
     size_t polynom_degree_ = 2;
     // polynomial
-    std::optional<Polynomial> polynom_;
+    std::optional<PolynomialType> polynom_;
+    SolveMode solve_mode_ = SolveMode::REFINED;
+    std::optional<RefinedSolution<T>> refined_solution_;
+    // sums of the last fit by the system of equations
+    std::optional<BasicMoments<T>> moments_;
+    GridMode grid_mode_ = GridMode::GENERAL;
+    // basis of the last fit on the uniform grid, reused while the number of points and the degree are the same
+    std::shared_ptr<const GramBasis<T>> gram_basis_;
 };
+
+using Approximator = BasicApproximator<double>;
+// halves memory of the data, for huge fits of low degree
+using FloatApproximator = BasicApproximator<float>;
+// for ill-conditioned fits of high degree
+using LongDoubleApproximator = BasicApproximator<long double>;
+// mixed modes: the system is accumulated in the wider type and solved in the narrower one
+using MixedFloatApproximator = BasicApproximator<float, double>;
+using MixedDoubleApproximator = BasicApproximator<double, long double>;
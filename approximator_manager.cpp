@@ -1,7 +1,65 @@
 #include "approximator_manager.h"
+#include "alloc_tracker.h"
+#include "profiler.h"
+
+namespace {
+
+// returns points of the function over the range
+template <typename Function>
+std::vector<Data> GenerateFunctionPoints(const Function& function, std::pair<double, double> range) {
+    PROFILE_SCOPE("ApproximatorManager::GenerateData");
+    ALLOC_STAGE("render/points");
+    return GeneratePoints(function, range.first, range.second, 1000);
+}
+
+}  // namespace
 
 void ApproximatorManager::RenderGraph(std::ostream& out) const {
     auto source_points = app_.GetData();
+    auto result_points = GetResultPoints(source_points);
+
+    renderer_.Render(source_points, result_points, out, GetConfidenceBand(result_points));
+}
+
+void ApproximatorManager::RenderGraph(const Polynomial& polynom, std::ostream& out) const {
+    auto source_points = app_.GetData();
+    auto result_points = GenerateFunctionPoints(polynom, GetResultRange(source_points));
+
+    renderer_.Render(source_points, result_points, out);
+}
+
+void ApproximatorManager::RenderGraph(const RationalFunction& function, std::ostream& out) const {
+    auto source_points = app_.GetData();
+    auto result_points = GenerateFunctionPoints(function, GetResultRange(source_points));
+
+    renderer_.Render(source_points, result_points, out);
+}
+
+// renders graph to the image without svg
+void ApproximatorManager::RenderImage(std::ostream& out, raster::ImageFormat format) const {
+    auto source_points = app_.GetData();
+    auto result_points = GetResultPoints(source_points);
+
+    renderer_.RenderImage(source_points, result_points, GetConfidenceBand(result_points)).Write(out, format);
+}
+
+void ApproximatorManager::RenderImage(const Polynomial& polynom, std::ostream& out, raster::ImageFormat format) const {
+    auto source_points = app_.GetData();
+    auto result_points = GenerateFunctionPoints(polynom, GetResultRange(source_points));
+
+    renderer_.RenderImage(source_points, result_points).Write(out, format);
+}
+
+void ApproximatorManager::RenderImage(const RationalFunction& function, std::ostream& out,
+                                      raster::ImageFormat format) const {
+    auto source_points = app_.GetData();
+    auto result_points = GenerateFunctionPoints(function, GetResultRange(source_points));
+
+    renderer_.RenderImage(source_points, result_points).Write(out, format);
+}
+
+// returns the range of x of source points with padding
+std::pair<double, double> ApproximatorManager::GetResultRange(const std::vector<Data>& source_points) const {
     auto [iter_min, iter_max] = std::minmax_element(source_points.begin(), source_points.end(),
         [](Data lhs, Data rhs) {
             return lhs.x < rhs.x;
@@ -11,22 +69,30 @@ void ApproximatorManager::RenderGraph(std::ostream& out) const {
     double max_x = iter_max->x;
     double padding = (max_x - min_x) * 0.1;
 
-    auto result_points = GenerateData(min_x - padding, max_x + padding, 1000);
+    return {min_x - padding, max_x + padding};
+}
 
-    renderer_.Render(source_points, result_points).Render(out);
+// returns points of the polynomial over the range of source points with padding
+std::vector<Data> ApproximatorManager::GetResultPoints(const std::vector<Data>& source_points) const {
+    const auto [min_x, max_x] = GetResultRange(source_points);
+    return GenerateData(min_x, max_x, 1000);
 }
 
 std::vector<Data> ApproximatorManager::GenerateData(double min_x, double max_x, size_t count) const {
-    std::vector<Data> points(count);
-    const Polynomial polynom = app_.GetPolynom();
-
-    const double step = (max_x - min_x) / (count - 1);
-    double next = min_x;
+    PROFILE_SCOPE("ApproximatorManager::GenerateData");
+    ALLOC_STAGE("render/points");
+    return GeneratePoints(app_.GetPolynom(), min_x, max_x, count);
+}
 
-    for (Data& point : points) {
-        point.x = next;
-        point.y = polynom(point.x);
-        next += step;
+// returns half-widths of the confidence band at the points if the renderer draws it
+std::vector<double> ApproximatorManager::GetConfidenceBand(const std::vector<Data>& result_points) const {
+    const renderer::RenderSettings& settings = renderer_.GetSettings();
+    if (!settings.draw_confidence_band) {
+        return {};
     }
-    return points;
-}
\ No newline at end of file
+    const auto covariance = app_.GetCovariance();
+    if (!covariance) {
+        return {};
+    }
+    return ::GetConfidenceBand(*covariance, result_points, settings.confidence_z);
+}
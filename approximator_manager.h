@@ -2,6 +2,7 @@
 
 #include "approximator.h"
 #include "graph_renderer.h"
+#include "rational_function.h"
 
 #include <iostream>
 
@@ -9,15 +10,31 @@
 
 class ApproximatorManager {
 public:
-    explicit ApproximatorManager(Approximator& app, renderer::GraphRenderer& renderer)
+    explicit ApproximatorManager(Approximator& app, const renderer::GraphRenderer& renderer)
         : app_{app}, renderer_{renderer} {
     }
 
     void RenderGraph(std::ostream& out) const;
+    // render source data of the approximator with the given function instead of the fitted polynomial
+    void RenderGraph(const Polynomial& polynom, std::ostream& out) const;
+    void RenderGraph(const RationalFunction& function, std::ostream& out) const;
+
+    // renders graph to the image without svg
+    void RenderImage(std::ostream& out, raster::ImageFormat format) const;
+    void RenderImage(const Polynomial& polynom, std::ostream& out, raster::ImageFormat format) const;
+    void RenderImage(const RationalFunction& function, std::ostream& out, raster::ImageFormat format) const;
 private:
+    // returns the range of x of source points with padding
+    std::pair<double, double> GetResultRange(const std::vector<Data>& source_points) const;
+
+    // returns points of the polynomial over the range of source points with padding
+    std::vector<Data> GetResultPoints(const std::vector<Data>& source_points) const;
 
     std::vector<Data> GenerateData(double min_x, double max_x, size_t count) const;
 
+    // returns half-widths of the confidence band at the points if the renderer draws it
+    std::vector<double> GetConfidenceBand(const std::vector<Data>& result_points) const;
+
     Approximator& app_;
-    renderer::GraphRenderer& renderer_;
+    const renderer::GraphRenderer& renderer_;
 };
\ No newline at end of file
@@ -0,0 +1,245 @@
+#include "batch_runner.h"
+
+#include "approximator_manager.h"
+#include "bounded_queue.h"
+#include "data_reader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std::literals;
+
+namespace {
+
+// data set passing through the pipeline
+struct Job {
+    size_t file_index = 0;
+    size_t index = 0;  // index of the data set in the file
+    std::string file_stem;
+    io::FitRequest request;
+    Approximator app;
+    io::FitResult result;
+    std::string graph;  // svg or image
+    std::string graph_name;  // file name of the graph without extension
+};
+
+struct InputFile {
+    size_t index;
+    std::string path;
+};
+
+// starts threads_count threads which pop items from the input and pass them to process
+// output is closed when the last of the threads finishes
+template <typename In, typename Process>
+void StartStage(std::vector<std::thread>& threads, size_t threads_count,
+                BoundedQueue<In>& input, BoundedQueue<Job>& output, Process process) {
+    threads_count = std::max<size_t>(threads_count, 1);
+    auto active = std::make_shared<std::atomic<size_t>>(threads_count);
+
+    for (size_t i = 0; i < threads_count; ++i) {
+        threads.emplace_back([&input, &output, process, active] {
+            while (auto item = input.Pop()) {
+                process(std::move(*item), output);
+            }
+            if (--*active == 0) {
+                output.Close();
+            }
+        });
+    }
+}
+
+// returns the extension of graph files
+std::string GetGraphExtension(const std::optional<raster::ImageFormat>& format) {
+    if (!format) {
+        return ".svg"s;
+    }
+    switch (*format) {
+    case raster::ImageFormat::PPM:
+        return ".ppm"s;
+    case raster::ImageFormat::BMP:
+        return ".bmp"s;
+    case raster::ImageFormat::PNG:
+        return ".png"s;
+    }
+    return {};
+}
+
+// draws the function with the data of the approximator, the fitted polynomial if the function is not given,
+// to svg or to the image of the format
+template <typename... Function>
+void DrawGraph(const ApproximatorManager& manager, const std::optional<raster::ImageFormat>& format,
+               std::ostream& out, const Function&... function) {
+    if (format) {
+        manager.RenderImage(function..., out, *format);
+    } else {
+        manager.RenderGraph(function..., out);
+    }
+}
+
+// replaces symbols which can't be used in the file name
+std::string GetFileName(std::string name) {
+    std::replace_if(name.begin(), name.end(), [](unsigned char c) {
+        return !std::isalnum(c) && c != '_' && c != '-' && c != '.';
+    }, '_');
+    return name;
+}
+
+}  // namespace
+
+BatchRunner::BatchRunner(const renderer::RenderSettings& render_settings, const BatchSettings& settings,
+                         size_t default_degree)
+        : renderer_{render_settings}, settings_{settings}, default_degree_{default_degree} {
+    // threads of RANSAC would oversubscribe the threads of the fit stage
+    if (settings_.fit.robust) {
+        settings_.fit.robust->threads_count = 1;
+    }
+}
+
+// returns results in the order of input files and of data sets in them
+std::vector<io::FitResult> BatchRunner::Run(const std::vector<std::string>& input_paths,
+                                            std::ostream& errors) const {
+    // all paths are queued at once, so the queue never blocks the caller
+    BoundedQueue<InputFile> files(input_paths.size());
+    for (size_t i = 0; i < input_paths.size(); ++i) {
+        files.Push({i, input_paths[i]});
+    }
+    files.Close();
+
+    BoundedQueue<Job> parsed(settings_.queue_capacity);
+    BoundedQueue<Job> fitted(settings_.queue_capacity);
+    BoundedQueue<Job> rendered(settings_.queue_capacity);
+    std::mutex errors_mutex;
+
+    std::vector<std::thread> threads;
+
+    // read and parse
+    StartStage(threads, settings_.read_threads, files, parsed,
+        [this, &errors, &errors_mutex](InputFile file, BoundedQueue<Job>& output) {
+            std::vector<io::FitRequest> requests;
+            try {
+                std::ifstream in(file.path, std::ios::binary);
+                if (!in) {
+                    throw io::ParsingError("can't open the file"s);
+                }
+                requests = io::ReadRequests(io::ReadAll(in), default_degree_);
+            } catch (const std::exception& e) {
+                std::lock_guard lock(errors_mutex);
+                errors << file.path << ": "sv << e.what() << std::endl;
+                return;
+            }
+
+            const std::string stem = std::filesystem::path(file.path).stem().string();
+            // graphs of data sets whose names repeat in the file (or become equal in file names)
+            // get the index of the data set, so they don't overwrite each other
+            std::vector<std::string> graph_names(requests.size());
+            std::unordered_map<std::string, size_t> names_count;
+            for (size_t i = 0; i < requests.size(); ++i) {
+                graph_names[i] = GetFileName(stem + "_"s
+                    + (requests[i].name.empty() ? std::to_string(i) : requests[i].name));
+                ++names_count[graph_names[i]];
+            }
+            for (size_t i = 0; i < requests.size(); ++i) {
+                Job job;
+                job.file_index = file.index;
+                job.index = i;
+                job.file_stem = stem;
+                job.request = std::move(requests[i]);
+                job.graph_name = std::move(graph_names[i]);
+                if (names_count[job.graph_name] > 1) {
+                    job.graph_name += "_"s + std::to_string(i);
+                }
+                output.Push(std::move(job));
+            }
+    });
+
+    // fit
+    StartStage(threads, settings_.fit_threads, parsed, fitted,
+        [this](Job job, BoundedQueue<Job>& output) {
+            std::string name = job.request.name;
+            try {
+                job.result = ProcessRequest(job.request, settings_.fit, job.app);
+            } catch (const std::exception& e) {
+                // e.g. bad_alloc of a huge data set, the other jobs go on
+                job.result = io::FitResult();
+                job.result.name = std::move(name);
+                job.result.degree = job.request.degree;
+                job.result.error = "fit failed: "s + e.what();
+                job.app = Approximator();
+            }
+            output.Push(std::move(job));
+    });
+
+    // render
+    StartStage(threads, settings_.render_threads, fitted, rendered,
+        [this, &errors, &errors_mutex](Job job, BoundedQueue<Job>& output) {
+            if (!settings_.output_dir.empty() && job.app.GetPointsCount() > 0) {
+                try {
+                    std::ostringstream graph;
+                    const ApproximatorManager manager(job.app, renderer_);
+                    if (job.result.rational) {
+                        DrawGraph(manager, settings_.image_format, graph, *job.result.rational);
+                    } else if (job.result.max_error) {
+                        DrawGraph(manager, settings_.image_format, graph, *job.result.polynom);
+                    } else if (job.result.polynom) {
+                        DrawGraph(manager, settings_.image_format, graph);
+                    }
+                    job.graph = std::move(graph).str();
+                } catch (const std::exception& e) {
+                    // the fit is still written, only the graph is lost
+                    std::lock_guard lock(errors_mutex);
+                    errors << job.file_stem << " #"sv << job.index << ": graph failed: "sv << e.what() << std::endl;
+                }
+            }
+            // the data is not needed any more
+            job.app = Approximator();
+            output.Push(std::move(job));
+    });
+
+    // write on the calling thread
+    std::vector<std::tuple<size_t, size_t, io::FitResult>> results;
+    const std::string extension = GetGraphExtension(settings_.image_format);
+    std::unordered_set<std::string> graph_names;
+    while (auto job = rendered.Pop()) {
+        if (!job->graph.empty()) {
+            // names are unique in a file, but files of equal stems in different directories
+            // (or stems equal in file names) still can meet here
+            if (!graph_names.insert(job->graph_name).second) {
+                job->graph_name += "_"s + std::to_string(job->file_index) + "_"s + std::to_string(job->index);
+                graph_names.insert(job->graph_name);
+            }
+            const auto path = std::filesystem::path(settings_.output_dir) / (job->graph_name + extension);
+
+            std::ofstream out(path, std::ios::binary);
+            out.write(job->graph.data(), job->graph.size());
+            if (!out) {
+                std::lock_guard lock(errors_mutex);
+                errors << path.string() << ": can't write the file"sv << std::endl;
+            }
+        }
+        results.emplace_back(job->file_index, job->index, std::move(job->result));
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::sort(results.begin(), results.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(std::get<0>(lhs), std::get<1>(lhs)) < std::tie(std::get<0>(rhs), std::get<1>(rhs));
+    });
+    std::vector<io::FitResult> sorted_results;
+    sorted_results.reserve(results.size());
+    for (auto& result : results) {
+        sorted_results.push_back(std::move(std::get<2>(result)));
+    }
+    return sorted_results;
+}
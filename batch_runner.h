@@ -0,0 +1,44 @@
+#pragma once
+
+#include "graph_renderer.h"
+#include "request_fitter.h"
+#include "result_writer.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+struct BatchSettings {
+    size_t read_threads = 1;  // threads reading and parsing input files
+    size_t fit_threads = 1;  // threads calculating polynomials
+    size_t render_threads = 1;  // threads building svg graphs
+    size_t queue_capacity = 16;  // max number of data sets waiting between two stages
+    // directory for graphs named <file stem>_<data set name or index>.svg, graphs are not rendered if it is empty
+    // repeated names get the index of the data set: <file stem>_<name>_<index>.svg
+    std::string output_dir;
+    // graphs are drawn straight to images of the format instead of svg
+    std::optional<raster::ImageFormat> image_format;
+    // the robust fit runs on one thread, the fit stage is the pool of threads
+    FitSettings fit;
+};
+
+// class runs a batch of data files through the pipeline:
+// read and parse -> fit -> render -> write
+// each stage has its own threads and is connected to the next by a bounded queue,
+// so all stages work at once and the batch takes about as long as the slowest stage
+class BatchRunner {
+public:
+    BatchRunner(const renderer::RenderSettings& render_settings, const BatchSettings& settings,
+                size_t default_degree = 2);
+
+    // returns results in the order of input files and of data sets in them
+    // files that can't be read or parsed are reported to the errors stream and skipped,
+    // failed fits are reported in their results
+    std::vector<io::FitResult> Run(const std::vector<std::string>& input_paths,
+                                   std::ostream& errors = std::cerr) const;
+
+private:
+    renderer::GraphRenderer renderer_;
+    BatchSettings settings_;
+    size_t default_degree_;
+};
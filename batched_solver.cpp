@@ -0,0 +1,179 @@
+#include "batched_solver.h"
+#include "alloc_tracker.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+template <typename T>
+BatchedEquationSystems<T>::BatchedEquationSystems(size_t size, size_t count)
+        : size_{size},
+          count_{count},
+          matrix_(size * size * count),
+          right_part_(size * count),
+          x_power_sums_(2 * size) {
+}
+
+template <typename T>
+std::vector<T> BatchedEquationSystems<T>::GetSolution(size_t system) const {
+    std::vector<T> res(size_);
+    for (size_t i = 0; i < size_; ++i) {
+        res[i] = GetSolutionAt(i, system);
+    }
+    return res;
+}
+
+template <typename T>
+void BatchedEquationSystems<T>::Set(size_t system, const BasicEquationSystem<T>& equation_system) {
+    const BasicMatrix<T>& matrix = equation_system.GetMatrix();
+    const std::vector<T>& right_part = equation_system.GetRightPart();
+    for (size_t i = 0; i < size_; ++i) {
+        for (size_t j = 0; j < size_; ++j) {
+            MatrixAt(i, j, system) = matrix[i][j];
+        }
+        RightPartAt(i, system) = right_part[i];
+    }
+}
+
+template <typename T>
+void BatchedEquationSystems<T>::SetLeastSquares(size_t system, const std::vector<BasicData<T>>& data) {
+    std::fill(x_power_sums_.begin(), x_power_sums_.end(), T{0});
+    for (size_t i = 0; i < size_; ++i) {
+        RightPartAt(i, system) = 0;
+    }
+
+    for (const BasicData<T>& point : data) {
+        T x_power = 1;
+        for (size_t k = 0; k < x_power_sums_.size(); ++k) {
+            x_power_sums_[k] += x_power;
+            if (k < size_) {
+                RightPartAt(k, system) += x_power * point.y;
+            }
+            x_power *= point.x;
+        }
+    }
+
+    // sum(x^(i + j)) in the row i and the column j, see GetMatrix in approximator.cpp
+    for (size_t i = 0; i < size_; ++i) {
+        for (size_t j = 0; j < size_; ++j) {
+            MatrixAt(i, j, system) = x_power_sums_[i + j];
+        }
+    }
+}
+
+template <typename T>
+std::vector<bool> BatchedEquationSystems<T>::Solve() {
+    PROFILE_SCOPE("BatchedEquationSystems::Solve");
+    ALLOC_STAGE("fit/solve");
+    PROFILE_COUNTER("systems", count_);
+    if (count_ == 0 || size_ == 0) {
+        return std::vector<bool>(count_, true);
+    }
+
+    // flags are kept in T to be vectorised together with the elimination
+    std::vector<T> solved(count_, T{1});
+    std::vector<T> acc(count_);
+    // pivot which lost all digits of the diagonal element means the singular matrix
+    const T tolerance = std::numeric_limits<T>::epsilon() * static_cast<T>(size_);
+
+    // A = L * L^T, L replaces the lower triangle of A
+    for (size_t j = 0; j < size_; ++j) {
+        T* diag = &MatrixAt(j, j, 0);
+        for (size_t s = 0; s < count_; ++s) {
+            acc[s] = diag[s];
+        }
+        for (size_t k = 0; k < j; ++k) {
+            const T* l_jk = &MatrixAt(j, k, 0);
+            for (size_t s = 0; s < count_; ++s) {
+                acc[s] -= l_jk[s] * l_jk[s];
+            }
+        }
+        for (size_t s = 0; s < count_; ++s) {
+            // failed systems get a unit pivot to keep the numbers finite
+            const bool positive = acc[s] > diag[s] * tolerance;
+            solved[s] = positive ? solved[s] : T{0};
+            diag[s] = positive ? std::sqrt(acc[s]) : T{1};
+        }
+
+        for (size_t i = j + 1; i < size_; ++i) {
+            T* l_ij = &MatrixAt(i, j, 0);
+            for (size_t s = 0; s < count_; ++s) {
+                acc[s] = l_ij[s];
+            }
+            for (size_t k = 0; k < j; ++k) {
+                const T* l_ik = &MatrixAt(i, k, 0);
+                const T* l_jk = &MatrixAt(j, k, 0);
+                for (size_t s = 0; s < count_; ++s) {
+                    acc[s] -= l_ik[s] * l_jk[s];
+                }
+            }
+            for (size_t s = 0; s < count_; ++s) {
+                l_ij[s] = acc[s] / diag[s];
+            }
+        }
+    }
+
+    // L * y = b
+    for (size_t i = 0; i < size_; ++i) {
+        T* y_i = &RightPartAt(i, 0);
+        for (size_t k = 0; k < i; ++k) {
+            const T* l_ik = &MatrixAt(i, k, 0);
+            const T* y_k = &RightPartAt(k, 0);
+            for (size_t s = 0; s < count_; ++s) {
+                y_i[s] -= l_ik[s] * y_k[s];
+            }
+        }
+        const T* l_ii = &MatrixAt(i, i, 0);
+        for (size_t s = 0; s < count_; ++s) {
+            y_i[s] /= l_ii[s];
+        }
+    }
+
+    // L^T * x = y
+    for (size_t i = size_; i-- > 0;) {
+        T* x_i = &RightPartAt(i, 0);
+        for (size_t k = i + 1; k < size_; ++k) {
+            const T* l_ki = &MatrixAt(k, i, 0);
+            const T* x_k = &RightPartAt(k, 0);
+            for (size_t s = 0; s < count_; ++s) {
+                x_i[s] -= l_ki[s] * x_k[s];
+            }
+        }
+        const T* l_ii = &MatrixAt(i, i, 0);
+        for (size_t s = 0; s < count_; ++s) {
+            x_i[s] /= l_ii[s];
+        }
+    }
+
+    std::vector<bool> res(count_);
+    for (size_t s = 0; s < count_; ++s) {
+        res[s] = solved[s] != 0;
+    }
+    return res;
+}
+
+template <typename T>
+std::vector<std::optional<BasicPolynomial<T>>> FitBatch(const std::vector<std::vector<BasicData<T>>>& data_sets,
+                                                        size_t degree) {
+    BatchedEquationSystems<T> systems(degree + 1, data_sets.size());
+    for (size_t i = 0; i < data_sets.size(); ++i) {
+        systems.SetLeastSquares(i, data_sets[i]);
+    }
+    const std::vector<bool> solved = systems.Solve();
+
+    std::vector<std::optional<BasicPolynomial<T>>> res(data_sets.size());
+    for (size_t i = 0; i < data_sets.size(); ++i) {
+        if (solved[i]) {
+            res[i] = BasicPolynomial<T>(systems.GetSolution(i));
+        }
+    }
+    return res;
+}
+
+template class BatchedEquationSystems<float>;
+template class BatchedEquationSystems<double>;
+template std::vector<std::optional<BasicPolynomial<float>>> FitBatch<float>(
+    const std::vector<std::vector<BasicData<float>>>&, size_t);
+template std::vector<std::optional<BasicPolynomial<double>>> FitBatch<double>(
+    const std::vector<std::vector<BasicData<double>>>&, size_t);
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "approximator.h"
+
+#include <optional>
+#include <vector>
+
+// many systems of equations of the same size solved together
+// element (row, col) of all systems is stored contiguously (structure of arrays),
+// so every step of the elimination is a loop over systems which the compiler vectorises
+// templates are explicitly instantiated for float and double in batched_solver.cpp
+template <typename T>
+class BatchedEquationSystems {
+public:
+    // count systems with size equations each, filled with zeros
+    BatchedEquationSystems(size_t size, size_t count);
+
+    size_t GetSize() const {
+        return size_;
+    }
+    size_t GetCount() const {
+        return count_;
+    }
+
+    T& MatrixAt(size_t row, size_t col, size_t system) {
+        return matrix_[(row * size_ + col) * count_ + system];
+    }
+    T& RightPartAt(size_t row, size_t system) {
+        return right_part_[row * count_ + system];
+    }
+    // after Solve holds the solution
+    T GetSolutionAt(size_t row, size_t system) const {
+        return right_part_[row * count_ + system];
+    }
+    std::vector<T> GetSolution(size_t system) const;
+
+    // copies the system with the same size
+    void Set(size_t system, const BasicEquationSystem<T>& equation_system);
+    // fills the system of least squares method for the polynomial of size - 1 degree
+    // sums are accumulated straight into the batch, without allocations
+    void SetLeastSquares(size_t system, const std::vector<BasicData<T>>& data);
+
+    // solves all systems by Cholesky decomposition, the matrices must be symmetric
+    // (only the lower triangle is read) and positive definite as matrices of least squares are
+    // the batch is destroyed, solutions are read by GetSolutionAt
+    // returns flags of solved systems, false for the matrices which are not positive definite
+    // or lose all digits of a diagonal element during the decomposition
+    std::vector<bool> Solve();
+
+private:
+    size_t size_;
+    size_t count_;
+    std::vector<T> matrix_;
+    std::vector<T> right_part_;
+    // sums of x powers of the current system, reused by SetLeastSquares
+    std::vector<T> x_power_sums_;
+};
+
+// fits every data set with the polynomial of the degree using one batched solve
+// the polynomial is empty for data sets whose system has no solution
+// the fits are not refined, unlike SolveMode::REFINED of Approximator, so the batch pipeline
+// (BatchRunner) and the requests don't use it: it is for the callers that fit many small data sets
+// of one degree at once and accept the plain precision; approximator_bench compares it with Approximator
+template <typename T>
+std::vector<std::optional<BasicPolynomial<T>>> FitBatch(const std::vector<std::vector<BasicData<T>>>& data_sets,
+                                                        size_t degree);
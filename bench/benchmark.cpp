@@ -0,0 +1,101 @@
+#include "benchmark.h"
+
+#include <charconv>
+#include <string_view>
+
+namespace bench {
+
+using namespace std::literals;
+
+void Runner::Run(const std::string& name, size_t size, size_t degree, size_t items,
+                 const std::function<void()>& op) {
+    if (!IsSelected(name)) {
+        return;
+    }
+    using Clock = std::chrono::steady_clock;
+
+    // warm up caches and find how long one call takes
+    op();
+
+    size_t iterations = 0;
+    // the vector of stages is allocated before the counters are taken
+    const std::vector<alloc::StageStats> start_stages = alloc::GetStageStats();
+    const alloc::Stats start_stats = alloc::GetTotalStats();
+    const auto start = Clock::now();
+    auto elapsed = Clock::duration::zero();
+    do {
+        op();
+        ++iterations;
+        elapsed = Clock::now() - start;
+    } while (elapsed < min_time_);
+    const alloc::Stats end_stats = alloc::GetTotalStats();
+    const std::vector<alloc::StageStats> end_stages = alloc::GetStageStats();
+
+    Result result;
+    result.name = name;
+    result.size = size;
+    result.degree = degree;
+    result.iterations = iterations;
+    result.ns_per_op = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    result.items_per_second = result.ns_per_op > 0 ? items * 1e9 / result.ns_per_op : 0;
+    result.allocations_per_op = static_cast<double>(end_stats.allocations - start_stats.allocations) / iterations;
+    result.bytes_per_op = static_cast<double>(end_stats.bytes - start_stats.bytes) / iterations;
+    if (alloc::IsEnabled()) {
+        // stages registered during the run have no start counters
+        for (size_t i = 0; i < end_stages.size(); ++i) {
+            const alloc::Stats start_stage = i < start_stages.size() ? start_stages[i].stats : alloc::Stats{};
+            const uint64_t allocations = end_stages[i].stats.allocations - start_stage.allocations;
+            if (allocations > 0) {
+                result.stages.push_back({end_stages[i].name,
+                                         static_cast<double>(allocations) / iterations,
+                                         static_cast<double>(end_stages[i].stats.bytes - start_stage.bytes) / iterations});
+            }
+        }
+    }
+
+    std::cerr << name << " size="sv << size << " degree="sv << degree
+              << ": "sv << result.ns_per_op << " ns/op"sv << std::endl;
+    results_.push_back(std::move(result));
+}
+
+// returns true if benchmarks with the name are not skipped by the filter
+bool Runner::IsSelected(std::string_view name) const {
+    return name.find(filter_) != std::string_view::npos;
+}
+
+void Runner::WriteJson(std::ostream& out) const {
+    auto number = [](double value) {
+        char buffer[32];
+        const auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+        return std::string(buffer, end);
+    };
+
+    out << "{\"benchmarks\": ["sv;
+    bool first = true;
+    for (const Result& result : results_) {
+        out << (first ? "\n  "sv : ",\n  "sv);
+        first = false;
+        out << "{\"name\": \""sv << result.name << "\""sv
+            << ", \"size\": "sv << result.size
+            << ", \"degree\": "sv << result.degree
+            << ", \"iterations\": "sv << result.iterations
+            << ", \"ns_per_op\": "sv << number(result.ns_per_op)
+            << ", \"items_per_second\": "sv << number(result.items_per_second)
+            << ", \"allocations_per_op\": "sv << number(result.allocations_per_op)
+            << ", \"bytes_per_op\": "sv << number(result.bytes_per_op);
+        if (!result.stages.empty()) {
+            out << ", \"stages\": ["sv;
+            for (size_t i = 0; i < result.stages.size(); ++i) {
+                const StageAllocations& stage = result.stages[i];
+                out << (i > 0 ? ", "sv : ""sv) << "{\"stage\": \""sv << stage.stage << "\""sv
+                    << ", \"allocations_per_op\": "sv << number(stage.allocations_per_op)
+                    << ", \"bytes_per_op\": "sv << number(stage.bytes_per_op) << "}"sv;
+            }
+            out << "]"sv;
+        }
+        out << "}"sv;
+    }
+    out << "\n]}\n"sv;
+}
+
+}  // namespace bench
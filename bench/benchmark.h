@@ -0,0 +1,72 @@
+#pragma once
+
+#include "alloc_tracker.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+
+// allocations of one stage of the pipeline per operation
+struct StageAllocations {
+    std::string_view stage;
+    double allocations_per_op = 0;
+    double bytes_per_op = 0;
+};
+
+// result of one benchmark with the parameters
+struct Result {
+    std::string name;
+    size_t size = 0;  // number of points
+    size_t degree = 0;  // degree of polynomial
+    size_t iterations = 0;
+    double ns_per_op = 0;
+    double items_per_second = 0;  // points processed per second
+    double allocations_per_op = 0;
+    double bytes_per_op = 0;  // allocated bytes per operation
+    // allocations by stages, filled only with -DAPPROXIMATOR_ALLOC_TRACKING=ON
+    std::vector<StageAllocations> stages;
+};
+
+// runs functions repeatedly until min_time is spent and collects results
+class Runner {
+public:
+    Runner(std::chrono::duration<double> min_time, std::string filter)
+        : min_time_{min_time}, filter_{std::move(filter)} {
+    }
+
+    // runs op, items is the number of points processed by one call
+    // benchmarks with names not containing the filter are skipped
+    void Run(const std::string& name, size_t size, size_t degree, size_t items,
+             const std::function<void()>& op);
+
+    // returns true if benchmarks with the name are not skipped by the filter,
+    // so expensive setup of the skipped ones can be skipped too
+    bool IsSelected(std::string_view name) const;
+
+    // writes results as JSON: {"benchmarks": [{"name": ..., "ns_per_op": ..., "stages": [...]}, ...]}
+    void WriteJson(std::ostream& out) const;
+
+private:
+    std::chrono::duration<double> min_time_;
+    std::string filter_;
+    std::vector<Result> results_;
+};
+
+// prevents the compiler from removing calculation of the value
+template <typename T>
+void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "m"(value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+#endif
+}
+
+}  // namespace bench
@@ -0,0 +1,578 @@
+#include "benchmark.h"
+
+#include "approximator.h"
+#include "batched_solver.h"
+#include "data_reducer.h"
+#include "fit_report.h"
+#include "gram_basis.h"
+#include "graph_renderer.h"
+#include "minimax_fitter.h"
+#include "multivariate_fitter.h"
+#include "polynomial_calculus.h"
+#include "property_library.h"
+#include "rational_function.h"
+#include "robust_fitter.h"
+#include "window_fitter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <cmath>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <streambuf>
+#include <string_view>
+#include <utility>
+
+using namespace std::literals;
+
+namespace {
+
+// stream buffer which only counts written characters
+class CountingBuffer : public std::streambuf {
+public:
+    size_t GetCount() const {
+        return count_;
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        ++count_;
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize count) override {
+        count_ += static_cast<size_t>(count);
+        return count;
+    }
+
+private:
+    size_t count_ = 0;
+};
+
+// noisy points of the polynomial with random coefficients
+std::vector<Data> GenerateNoisyData(size_t degree, size_t count) {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<> coeff_dis(1.0, 5.0);
+    std::normal_distribution<> noise_dis(0.0, 0.1);
+
+    std::vector<double> coeffs(degree + 1);
+    for (double& coeff : coeffs) {
+        coeff = coeff_dis(gen);
+    }
+    std::vector<Data> data = GeneratePoints(Polynomial(coeffs), -1.0, 1.0, count);
+    for (Data& point : data) {
+        point.y += noise_dis(gen);
+    }
+    return data;
+}
+
+renderer::RenderSettings GetRenderSettings() {
+    return {
+        .width = 500,
+        .height = 500,
+        .padding = 10,
+        .line_width = 1,
+        .radius = 3,
+        .line_color = svg::Color("Black"s),
+        .circle_color = svg::Color("Red"s)
+    };
+}
+
+// fits the data converted to the precision of the approximator
+template <typename App>
+void RunFit(bench::Runner& runner, const std::string& name, const std::vector<Data>& data, size_t degree) {
+    using Scalar = decltype(std::declval<typename App::DataType>().x);
+    const auto converted = ConvertData<Scalar>(data);
+    runner.Run(name, data.size(), degree, data.size(), [&] {
+        App app;
+        auto copy = converted;
+        app.SetData(copy);
+        bench::DoNotOptimize(app.GetPolynom(degree));
+    });
+}
+
+void RunBenchmarks(bench::Runner& runner, size_t max_size) {
+    std::vector<size_t> sizes;
+    for (size_t size = 100; size <= max_size; size *= 10) {
+        sizes.push_back(size);
+    }
+
+    // x powers and sums of moments
+    for (size_t degree : {2, 5}) {
+        for (size_t size : sizes) {
+            const auto data = GenerateNoisyData(degree, size);
+            runner.Run("moments/GetEquationSystem"s, size, degree, size, [&] {
+                bench::DoNotOptimize(GetEquationSystem(data, static_cast<int>(degree)));
+            });
+        }
+    }
+
+    // solution of the system, its size is degree + 1
+    for (size_t degree = 1; degree <= 10; ++degree) {
+        const auto system = GetEquationSystem(GenerateNoisyData(degree, 1000), static_cast<int>(degree));
+        runner.Run("solve/EquationSystem::GetSolve"s, degree + 1, degree, 1, [&] {
+            // GetSolve changes the system, so it works with a copy
+            bench::DoNotOptimize(EquationSystem(system).GetSolve());
+        });
+        runner.Run("solve/EquationSystem::GetRefinedSolve"s, degree + 1, degree, 1, [&] {
+            bench::DoNotOptimize(system.GetRefinedSolve());
+        });
+    }
+
+    // many small systems one by one and in the batch
+    const size_t systems_count = 1024;
+    const bool systems_selected = runner.IsSelected("solve/EquationSystem::GetSolve x1024"sv)
+        || runner.IsSelected("solve/BatchedEquationSystems<double> x1024"sv);
+    for (size_t degree = 2; degree <= 7 && systems_selected; ++degree) {
+        std::vector<EquationSystem> systems;
+        for (size_t i = 0; i < systems_count; ++i) {
+            systems.push_back(GetEquationSystem(GenerateNoisyData(degree, 50), static_cast<int>(degree)));
+        }
+        runner.Run("solve/EquationSystem::GetSolve x1024"s, degree + 1, degree, systems_count, [&] {
+            for (const EquationSystem& system : systems) {
+                bench::DoNotOptimize(EquationSystem(system).GetSolve());
+            }
+        });
+        runner.Run("solve/BatchedEquationSystems<double> x1024"s, degree + 1, degree, systems_count, [&] {
+            BatchedEquationSystems<double> batch(degree + 1, systems_count);
+            for (size_t i = 0; i < systems_count; ++i) {
+                batch.Set(i, systems[i]);
+            }
+            bench::DoNotOptimize(batch.Solve());
+        });
+    }
+
+    // many small data sets fitted one by one and in the batch
+    const bool data_sets_selected = runner.IsSelected("fit/Approximator::GetPolynom x1024"sv)
+        || runner.IsSelected("fit/FitBatch<double> x1024"sv);
+    for (size_t degree : {2, 7}) {
+        if (!data_sets_selected) {
+            break;
+        }
+        const size_t points_count = 50;
+        std::vector<std::vector<Data>> data_sets;
+        for (size_t i = 0; i < systems_count; ++i) {
+            data_sets.push_back(GenerateNoisyData(degree, points_count));
+        }
+        runner.Run("fit/Approximator::GetPolynom x1024"s, points_count, degree, systems_count * points_count, [&] {
+            for (const auto& data : data_sets) {
+                Approximator app;
+                auto copy = data;
+                app.SetData(copy);
+                bench::DoNotOptimize(app.GetPolynom(degree));
+            }
+        });
+        runner.Run("fit/FitBatch<double> x1024"s, points_count, degree, systems_count * points_count, [&] {
+            bench::DoNotOptimize(FitBatch(data_sets, degree));
+        });
+    }
+
+    // evaluation of the polynomial
+    for (size_t degree : {2, 5, 10}) {
+        for (size_t size : sizes) {
+            const auto data = GenerateNoisyData(degree, size);
+            const Polynomial polynom(std::vector<double>(degree + 1, 1.5));
+            runner.Run("evaluate/Polynomial"s, size, degree, size, [&] {
+                double sum = 0;
+                for (const Data& point : data) {
+                    sum += polynom(point.x);
+                }
+                bench::DoNotOptimize(sum);
+            });
+        }
+    }
+
+    // rational function of degrees 3/3 of the smooth curve
+    for (size_t size : sizes) {
+        const size_t degree = 3;
+        std::vector<Data> data;
+        for (size_t i = 0; i < size; ++i) {
+            const double x = 1 + 4.0 * static_cast<double>(i) / static_cast<double>(size);
+            data.push_back({x, std::exp(1.5 / x)});
+        }
+        runner.Run("fit/FitRational(3/3)"s, size, degree, size, [&] {
+            bench::DoNotOptimize(FitRational(data, degree, degree));
+        });
+
+        if (!runner.IsSelected("evaluate/RationalFunction"sv)) {
+            continue;
+        }
+        const auto function = FitRational(data, degree, degree);
+        if (!function) {
+            std::cerr << "FitRational(3/3) failed for "sv << size << " points"sv << std::endl;
+            continue;
+        }
+        std::vector<double> x(data.size());
+        std::transform(data.begin(), data.end(), x.begin(), [](Data point) {
+            return point.x;
+        });
+        runner.Run("evaluate/RationalFunction(3/3)"s, size, degree, size, [&] {
+            double sum = 0;
+            for (double value : x) {
+                sum += (*function)(value);
+            }
+            bench::DoNotOptimize(sum);
+        });
+        runner.Run("evaluate/RationalFunction::Evaluate(3/3)"s, size, degree, size, [&] {
+            bench::DoNotOptimize(function->Evaluate(x));
+        });
+    }
+
+    // value with two derivatives, integrals and inverse of the monotonic polynomial of degree 6
+    for (size_t size : sizes) {
+        const size_t degree = 6;
+        const Polynomial polynom({1, 2, 0.5, 0.25, 0.125, 0.0625, 0.03125});
+        const Polynomial first = GetDerivative(polynom);
+        const Polynomial second = GetDerivative(first);
+        std::vector<double> x(size);
+        for (size_t i = 0; i < size; ++i) {
+            x[i] = 2.0 * static_cast<double>(i) / static_cast<double>(size);
+        }
+        runner.Run("calculus/Polynomial x3 (value, p', p'')"s, size, degree, size, [&] {
+            double sum = 0;
+            for (double value : x) {
+                sum += polynom(value) + first(value) + second(value);
+            }
+            bench::DoNotOptimize(sum);
+        });
+        runner.Run("calculus/EvaluateDerivatives(2)"s, size, degree, size, [&] {
+            bench::DoNotOptimize(EvaluateDerivatives(polynom, x, 2));
+        });
+
+        std::vector<double> a(size, 0.0);
+        runner.Run("calculus/integral by trapezoids x100"s, size, degree, size, [&] {
+            double sum = 0;
+            for (double b : x) {
+                const double step = b / 100;
+                double integral = (polynom(0) + polynom(b)) / 2;
+                for (size_t i = 1; i < 100; ++i) {
+                    integral += polynom(step * static_cast<double>(i));
+                }
+                sum += integral * step;
+            }
+            bench::DoNotOptimize(sum);
+        });
+        runner.Run("calculus/Integrate(batch)"s, size, degree, size, [&] {
+            bench::DoNotOptimize(Integrate(polynom, a, x));
+        });
+
+        std::vector<double> y(size);
+        std::transform(x.begin(), x.end(), y.begin(), polynom);
+        runner.Run("calculus/SolveInverse"s, size, degree, size, [&] {
+            bench::DoNotOptimize(SolveInverse(polynom, y, 0.0, 2.0));
+        });
+    }
+
+    // the lowest degrees meeting the max error bound by least squares and by minimax polynomials
+    for (size_t size : sizes) {
+        std::vector<Data> data;
+        for (size_t i = 0; i < size; ++i) {
+            const double x = 2.0 * static_cast<double>(i) / static_cast<double>(size);
+            data.push_back({x, std::exp(x)});
+        }
+        MinimaxSettings settings;
+        settings.max_error = 1e-6;
+        runner.Run("fit/FitMinimaxToBound(1e-6)"s, size, settings.max_degree, size, [&] {
+            bench::DoNotOptimize(FitMinimaxToBound(data, settings));
+        });
+
+        const std::string least_squares_name = "evaluate/Polynomial(least squares, 1e-6)"s;
+        const std::string minimax_name = "evaluate/Polynomial(minimax, 1e-6)"s;
+        // the search of the degree is the setup of the evaluation only
+        std::optional<Polynomial> least_squares;
+        for (size_t degree = 1; degree <= settings.max_degree && !least_squares
+                && runner.IsSelected(least_squares_name); ++degree) {
+            Approximator app;
+            app.SetSolveMode(SolveMode::REFINED);
+            auto copy = data;
+            app.SetData(copy);
+            const auto polynom = app.GetPolynom(degree);
+            const bool meets_bound = polynom && std::all_of(data.begin(), data.end(), [&](Data point) {
+                return std::abs((*polynom)(point.x) - point.y) <= settings.max_error;
+            });
+            if (meets_bound) {
+                least_squares = polynom;
+            }
+        }
+        const auto minimax = runner.IsSelected(minimax_name) ? FitMinimaxToBound(data, settings) : std::nullopt;
+        const std::pair<std::optional<Polynomial>, std::string> polynoms[] = {
+            {least_squares, least_squares_name},
+            {minimax ? std::optional(minimax->polynom) : std::nullopt, minimax_name}
+        };
+        for (const auto& [polynom, name] : polynoms) {
+            if (!polynom) {
+                continue;
+            }
+            runner.Run(name, size, polynom->coeffs.size() - 1, size, [&] {
+                double sum = 0;
+                for (const Data& point : data) {
+                    sum += (*polynom)(point.x);
+                }
+                bench::DoNotOptimize(sum);
+            });
+        }
+    }
+
+    // the whole approximation
+    for (size_t size : sizes) {
+        const size_t degree = 3;
+        const auto data = GenerateNoisyData(degree, size);
+        runner.Run("fit/Approximator::GetPolynom"s, size, degree, size, [&] {
+            Approximator app;
+            auto copy = data;
+            app.SetData(copy);
+            bench::DoNotOptimize(app.GetPolynom(degree));
+        });
+    }
+
+    // repeated measurements: points on 1000 distinct x in random order, fitted as is and merged into weighted points
+    for (size_t size : sizes) {
+        const size_t degree = 3;
+        const size_t distinct_count = 1000;
+        auto data = GenerateNoisyData(degree, size);
+        std::mt19937 gen(7);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i].x = -1 + 2.0 * static_cast<double>(i % distinct_count) / distinct_count;
+        }
+        std::shuffle(data.begin(), data.end(), gen);
+        runner.Run("reduce/Approximator::GetPolynom(raw)"s, size, degree, size, [&] {
+            Approximator app;
+            auto copy = data;
+            app.SetData(copy);
+            bench::DoNotOptimize(app.GetPolynom(degree));
+        });
+        runner.Run("reduce/ReduceData(DUPLICATES)"s, size, degree, size, [&] {
+            bench::DoNotOptimize(ReduceData(data));
+        });
+        runner.Run("reduce/ReduceData(BINS 256)"s, size, degree, size, [&] {
+            bench::DoNotOptimize(ReduceData(data, {ReductionMode::BINS, 256}));
+        });
+        const auto reduced = ReduceData(data);
+        runner.Run("reduce/Approximator::GetPolynom(reduced)"s, size, degree, size, [&] {
+            Approximator app;
+            app.SetData(reduced);
+            bench::DoNotOptimize(app.GetPolynom(degree));
+        });
+    }
+
+    // diagnostics of the fitted polynomial from the moments and by the pass over the data
+    for (size_t size : sizes) {
+        const size_t degree = 3;
+        auto data = GenerateNoisyData(degree, size);
+        Approximator app;
+        app.SetData(data);
+        app.GetPolynom(degree);
+        runner.Run("report/Approximator::GetSumSquaredErrors"s, size, degree, size, [&] {
+            bench::DoNotOptimize(app.GetSumSquaredErrors());
+        });
+        runner.Run("report/Approximator::GetFitReport(MOMENTS)"s, size, degree, size, [&] {
+            bench::DoNotOptimize(app.GetFitReport(ReportMode::MOMENTS));
+        });
+        runner.Run("report/Approximator::GetFitReport(DATA_PASS, 16 bins)"s, size, degree, size, [&] {
+            bench::DoNotOptimize(app.GetFitReport(ReportMode::DATA_PASS, 16));
+        });
+    }
+
+    // the approximation on the uniform grid by Gram polynomials
+    for (size_t size : sizes) {
+        const size_t degree = 3;
+        const auto data = GenerateNoisyData(degree, size);
+        runner.Run("fit/Approximator::GetPolynom(GridMode::AUTO)"s, size, degree, size, [&] {
+            Approximator app;
+            app.SetGridMode(GridMode::AUTO);
+            auto copy = data;
+            app.SetData(copy);
+            bench::DoNotOptimize(app.GetPolynom(degree));
+        });
+        // repeated fits on the same grid with the cached basis
+        const GramBasis<double> basis(size, degree);
+        runner.Run("fit/GramBasis::Fit"s, size, degree, size, [&] {
+            bench::DoNotOptimize(basis.Fit(data));
+        });
+    }
+
+    // robust fits of the data with 10% of outliers
+    for (size_t size : sizes) {
+        const size_t degree = 3;
+        auto data = GenerateNoisyData(degree, size);
+        for (size_t i = 0; i < data.size(); i += 10) {
+            data[i].y += 100;
+        }
+        const std::pair<RobustMethod, std::string> methods[] = {
+            {RobustMethod::HUBER, "fit/FitRobust(HUBER)"s},
+            {RobustMethod::TUKEY, "fit/FitRobust(TUKEY)"s},
+            {RobustMethod::RANSAC, "fit/FitRobust(RANSAC)"s}
+        };
+        for (const auto& [method, name] : methods) {
+            RobustSettings settings;
+            settings.method = method;
+            runner.Run(name, size, degree, size, [&] {
+                bench::DoNotOptimize(FitRobust(data, degree, settings));
+            });
+        }
+    }
+
+    // polynomials of two variables, degree is the total degree
+    for (size_t size : sizes) {
+        const size_t degree = 3;
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<> dis(-1.0, 1.0);
+        MultiData data;
+        data.dimensions = 2;
+        for (size_t i = 0; i < size; ++i) {
+            const double t = dis(gen);
+            const double p = dis(gen);
+            data.Add({t, p}, 1 + 2 * t - 3 * p + 0.5 * t * p + 0.1 * dis(gen));
+        }
+        runner.Run("fit/FitMultivariate(2D)"s, size, degree, size, [&] {
+            bench::DoNotOptimize(FitMultivariate(data, degree));
+        });
+
+        const auto polynom = FitMultivariate(data, degree);
+        if (!polynom) {
+            std::cerr << "FitMultivariate(2D) failed for "sv << size << " points"sv << std::endl;
+            continue;
+        }
+        runner.Run("evaluate/MultiPolynomial(scalar)"s, size, degree, size, [&] {
+            double sum = 0;
+            for (size_t i = 0; i < data.GetCount(); ++i) {
+                sum += (*polynom)(&data.x[i * data.dimensions]);
+            }
+            bench::DoNotOptimize(sum);
+        });
+        runner.Run("evaluate/MultiPolynomial::Evaluate(batch)"s, size, degree, size, [&] {
+            bench::DoNotOptimize(polynom->Evaluate(data));
+        });
+    }
+
+    // sliding window over the stream, the cost of a sample must not depend on the window size
+    for (size_t window_size : {64, 1024, 16384}) {
+        const size_t degree = 2;
+        const size_t samples_count = 100'000;
+        const auto data = GenerateNoisyData(degree, samples_count);
+        runner.Run("fit/WindowFitter::AddSample x100000"s, window_size, degree, samples_count, [&] {
+            WindowFitter fitter(window_size, degree);
+            for (const Data& sample : data) {
+                fitter.AddSample(sample);
+            }
+            bench::DoNotOptimize(fitter.Evaluate(0));
+        });
+    }
+
+    // the whole approximation in other precisions
+    for (size_t size : sizes) {
+        const size_t degree = 3;
+        const auto data = GenerateNoisyData(degree, size);
+        RunFit<FloatApproximator>(runner, "fit/FloatApproximator::GetPolynom"s, data, degree);
+        RunFit<MixedFloatApproximator>(runner, "fit/MixedFloatApproximator::GetPolynom"s, data, degree);
+        RunFit<LongDoubleApproximator>(runner, "fit/LongDoubleApproximator::GetPolynom"s, data, degree);
+        RunFit<MixedDoubleApproximator>(runner, "fit/MixedDoubleApproximator::GetPolynom"s, data, degree);
+    }
+
+    // start-up of the library of fitted functions: mapping of the file and lookup of every name
+    // the file is written to the temporary directory, not to the current one
+    const std::string library_path
+        = (std::filesystem::temp_directory_path() / "approximator_bench_library.bin"s).string();
+    for (size_t count : {100, 1000, 10000}) {
+        if (!runner.IsSelected("io/Library::"sv)) {
+            break;
+        }
+        const size_t degree = 5;
+        library::LibraryWriter writer;
+        std::vector<std::string> names;
+        for (size_t i = 0; i < count; ++i) {
+            names.push_back("substance"s + std::to_string(i) + "/density"s);
+            writer.Add(names.back(), Polynomial(std::vector<double>(degree + 1, 1.5)), 0.0, 1.0);
+        }
+        {
+            std::ofstream out(library_path, std::ios::binary);
+            writer.Write(out);
+        }
+        runner.Run("io/Library::Open"s, count, degree, count, [&] {
+            bench::DoNotOptimize(library::Library::Open(library_path));
+        });
+        const auto functions = library::Library::Open(library_path);
+        if (!functions) {
+            std::cerr << "Can't open the library "sv << library_path << std::endl;
+            std::remove(library_path.c_str());
+            continue;
+        }
+        runner.Run("io/Library::Find"s, count, degree, count, [&] {
+            double sum = 0;
+            for (const std::string& name : names) {
+                if (const auto function = functions->Find(name)) {
+                    sum += (*function)(0.5);
+                }
+            }
+            bench::DoNotOptimize(sum);
+        });
+        std::remove(library_path.c_str());
+    }
+
+    // rendering of svg graphs
+    const renderer::GraphRenderer graph_renderer(GetRenderSettings());
+    for (size_t size : sizes) {
+        const size_t degree = 3;
+        const auto source_points = GenerateNoisyData(degree, size);
+        const auto result_points = GeneratePoints(Polynomial(std::vector<double>(degree + 1, 1.0)),
+                                                  -1.2, 1.2, 1000);
+
+        runner.Run("render/svg::Document"s, size, degree, size, [&] {
+            CountingBuffer buffer;
+            std::ostream out(&buffer);
+            graph_renderer.Render(source_points, result_points).Render(out);
+            bench::DoNotOptimize(buffer.GetCount());
+        });
+        runner.Run("render/GraphRenderer::Render(stream)"s, size, degree, size, [&] {
+            CountingBuffer buffer;
+            std::ostream out(&buffer);
+            graph_renderer.Render(source_points, result_points, out);
+            bench::DoNotOptimize(buffer.GetCount());
+        });
+    }
+}
+
+void PrintUsage(std::ostream& out) {
+    out << "Usage: approximator_bench [--max-size N] [--min-time SECONDS] [--filter TEXT] >results.json\n"s
+        << "  sizes of data go from 100 to max-size (1000000 by default) by powers of 10\n"s;
+}
+
+template <typename T>
+bool ParseNumber(std::string_view str, T& value) {
+    const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    return ec == std::errc{} && ptr == str.data() + str.size();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t max_size = 1'000'000;
+    double min_time = 0.2;
+    std::string filter;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        bool ok = i + 1 < argc;
+        if (ok && arg == "--max-size"sv) {
+            ok = ParseNumber(argv[++i], max_size);
+        } else if (ok && arg == "--min-time"sv) {
+            ok = ParseNumber(argv[++i], min_time);
+        } else if (ok && arg == "--filter"sv) {
+            filter = argv[++i];
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            PrintUsage(std::cerr);
+            return 1;
+        }
+    }
+
+    bench::Runner runner(std::chrono::duration<double>(min_time), filter);
+    RunBenchmarks(runner, max_size);
+    runner.WriteJson(std::cout);
+}
@@ -0,0 +1,482 @@
+#include "data_reader.h"
+#include "alloc_tracker.h"
+#include "profiler.h"
+
+#include <charconv>
+#include <cmath>
+#include <optional>
+#include <string>
+
+namespace io {
+
+using namespace std::literals;
+
+namespace {
+
+// max nesting of arrays and objects, deeper input is rejected before the recursion overflows the stack
+const size_t MAX_NESTING_DEPTH = 256;
+
+// returns the error message if the request can't be approximated
+std::optional<std::string> CheckRequest(const FitRequest& request) {
+    if (request.data.empty()) {
+        return "no data"s;
+    }
+    if (request.degree >= request.data.size()) {
+        return "degree must be less than the number of points"s;
+    }
+    return std::nullopt;
+}
+
+bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// appends code point to the string in UTF-8
+void AppendUtf8(std::string& str, uint32_t code) {
+    if (code < 0x80) {
+        str += static_cast<char>(code);
+    } else if (code < 0x800) {
+        str += static_cast<char>(0xC0 | (code >> 6));
+        str += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        str += static_cast<char>(0xE0 | (code >> 12));
+        str += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        str += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        str += static_cast<char>(0xF0 | (code >> 18));
+        str += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        str += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        str += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+// recursive descent parser of the requests JSON
+// works over the whole text without building a document tree
+class JsonParser {
+public:
+    JsonParser(std::string_view text, size_t default_degree)
+        : text_{text}, default_degree_{default_degree} {
+    }
+
+    std::vector<FitRequest> ParseRoot() {
+        std::vector<FitRequest> requests;
+        SkipSpaces();
+        if (Consume('[')) {
+            ParseArray([this, &requests] {
+                requests.push_back(ParseRequest());
+            });
+        } else {
+            requests.push_back(ParseRequest());
+        }
+        SkipSpaces();
+        if (pos_ != text_.size()) {
+            Fail("unexpected data after the end of JSON"sv);
+        }
+        return requests;
+    }
+
+    FitRequest ParseRequest() {
+        FitRequest request;
+        request.degree = default_degree_;
+
+        Expect('{');
+        ParseObject([this, &request](std::string_view key) {
+            if (!ParseRequestValue(key, request)) {
+                SkipValue();
+            }
+        });
+        if (const auto error = CheckRequest(request)) {
+            Fail(*error);
+        }
+        return request;
+    }
+
+    ServerRequest ParseServerRequest() {
+        ServerRequest request;
+        request.fit.degree = default_degree_;
+
+        SkipSpaces();
+        Expect('{');
+        ParseObject([this, &request](std::string_view key) {
+            if (key == "command"sv) {
+                request.command = ParseString();
+            } else if (key == "x"sv) {
+                Expect('[');
+                ParseArray([this, &request] {
+                    request.x.push_back(ParseNumber());
+                });
+            } else if (!ParseRequestValue(key, request.fit)) {
+                SkipValue();
+            }
+        });
+        SkipSpaces();
+        if (pos_ != text_.size()) {
+            Fail("unexpected data after the end of JSON"sv);
+        }
+        // without data the stored data is refitted, it is checked by the server
+        if (!request.fit.data.empty()) {
+            if (const auto error = CheckRequest(request.fit)) {
+                Fail(*error);
+            }
+        }
+        return request;
+    }
+
+private:
+    // parses value of the fit request key, returns false for unknown keys
+    bool ParseRequestValue(std::string_view key, FitRequest& request) {
+        if (key == "name"sv) {
+            request.name = ParseString();
+        } else if (key == "degree"sv) {
+            const double degree = ParseNumber();
+            if (degree < 0 || degree != std::floor(degree)) {
+                Fail("degree must be a non-negative integer"sv);
+            }
+            if (degree > MAX_DEGREE) {
+                Fail("degree must not be greater than "s + std::to_string(MAX_DEGREE));
+            }
+            request.degree = static_cast<size_t>(degree);
+        } else if (key == "data"sv) {
+            Expect('[');
+            ParseArray([this, &request] {
+                request.data.push_back(ParsePoint());
+            });
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // [x, y] or {"x": x, "y": y}
+    Data ParsePoint() {
+        SkipSpaces();
+        Data point{};
+        if (Consume('[')) {
+            point.x = ParseNumber();
+            Expect(',');
+            point.y = ParseNumber();
+            Expect(']');
+            return point;
+        }
+
+        Expect('{');
+        bool has_x = false;
+        bool has_y = false;
+        ParseObject([&](std::string_view key) {
+            if (key == "x"sv) {
+                point.x = ParseNumber();
+                has_x = true;
+            } else if (key == "y"sv) {
+                point.y = ParseNumber();
+                has_y = true;
+            } else {
+                SkipValue();
+            }
+        });
+        if (!has_x || !has_y) {
+            Fail("point must have x and y"sv);
+        }
+        return point;
+    }
+
+    // parses items after '[' until ']'
+    template <typename ItemParser>
+    void ParseArray(ItemParser parse_item) {
+        EnterNesting();
+        SkipSpaces();
+        if (!Consume(']')) {
+            do {
+                parse_item();
+                SkipSpaces();
+            } while (Consume(','));
+            Expect(']');
+        }
+        --depth_;
+    }
+
+    // parses "key": value pairs after '{' until '}', parse_value gets the key
+    template <typename ValueParser>
+    void ParseObject(ValueParser parse_value) {
+        EnterNesting();
+        SkipSpaces();
+        if (!Consume('}')) {
+            do {
+                SkipSpaces();
+                const std::string key = ParseString();
+                Expect(':');
+                parse_value(std::string_view(key));
+                SkipSpaces();
+            } while (Consume(','));
+            Expect('}');
+        }
+        --depth_;
+    }
+
+    // counts the array or the object being parsed, the parser stops at the error so depth_ isn't restored
+    void EnterNesting() {
+        if (++depth_ > MAX_NESTING_DEPTH) {
+            Fail("arrays and objects are nested deeper than "s + std::to_string(MAX_NESTING_DEPTH));
+        }
+    }
+
+    double ParseNumber() {
+        SkipSpaces();
+        const char* begin = text_.data() + pos_;
+        const char* end = text_.data() + text_.size();
+        double value = 0;
+        const auto [ptr, ec] = std::from_chars(begin, end, value);
+        if (ec != std::errc{} || ptr == begin) {
+            Fail("number expected"sv);
+        }
+        // from_chars also reads nan and inf which are not JSON
+        if (!std::isfinite(value)) {
+            Fail("finite number expected"sv);
+        }
+        pos_ += ptr - begin;
+        return value;
+    }
+
+    std::string ParseString() {
+        SkipSpaces();
+        Expect('"');
+        std::string str;
+        while (true) {
+            // copy the run without escapes at once
+            const size_t special = text_.find_first_of("\"\\"sv, pos_);
+            if (special == std::string_view::npos) {
+                Fail("unterminated string"sv);
+            }
+            str.append(text_.substr(pos_, special - pos_));
+            pos_ = special + 1;
+            if (text_[special] == '"') {
+                return str;
+            }
+            ParseEscape(str);
+        }
+    }
+
+    void ParseEscape(std::string& str) {
+        if (pos_ >= text_.size()) {
+            Fail("unterminated string"sv);
+        }
+        const char c = text_[pos_++];
+        switch (c) {
+            case '"':
+            case '\\':
+            case '/':
+            str += c;
+            break;
+            case 'b':
+            str += '\b';
+            break;
+            case 'f':
+            str += '\f';
+            break;
+            case 'n':
+            str += '\n';
+            break;
+            case 'r':
+            str += '\r';
+            break;
+            case 't':
+            str += '\t';
+            break;
+            case 'u':
+            AppendUtf8(str, ParseCodePoint());
+            break;
+            default:
+            Fail("invalid escape sequence"sv);
+        }
+    }
+
+    // parses the code point after \u, characters above U+FFFF are written as the surrogate pair \uD8xx\uDCxx
+    uint32_t ParseCodePoint() {
+        const uint32_t code = ParseHex4();
+        if (code >= 0xDC00 && code <= 0xDFFF) {
+            Fail("unpaired low surrogate"sv);
+        }
+        if (code < 0xD800 || code > 0xDBFF) {
+            return code;
+        }
+        if (text_.substr(pos_, 2) != "\\u"sv) {
+            Fail("unpaired high surrogate"sv);
+        }
+        pos_ += 2;
+        const uint32_t low = ParseHex4();
+        if (low < 0xDC00 || low > 0xDFFF) {
+            Fail("unpaired high surrogate"sv);
+        }
+        return 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+    }
+
+    uint32_t ParseHex4() {
+        if (pos_ + 4 > text_.size()) {
+            Fail("invalid unicode escape"sv);
+        }
+        uint32_t code = 0;
+        const auto [ptr, ec] = std::from_chars(text_.data() + pos_, text_.data() + pos_ + 4, code, 16);
+        if (ec != std::errc{} || ptr != text_.data() + pos_ + 4) {
+            Fail("invalid unicode escape"sv);
+        }
+        pos_ += 4;
+        return code;
+    }
+
+    void SkipValue() {
+        SkipSpaces();
+        if (pos_ >= text_.size()) {
+            Fail("value expected"sv);
+        }
+        const char c = text_[pos_];
+        if (c == '{') {
+            ++pos_;
+            ParseObject([this](std::string_view) {
+                SkipValue();
+            });
+        } else if (c == '[') {
+            ++pos_;
+            ParseArray([this] {
+                SkipValue();
+            });
+        } else if (c == '"') {
+            ParseString();
+        } else if (!SkipLiteral("true"sv) && !SkipLiteral("false"sv) && !SkipLiteral("null"sv)) {
+            ParseNumber();
+        }
+    }
+
+    bool SkipLiteral(std::string_view literal) {
+        if (text_.substr(pos_, literal.size()) != literal) {
+            return false;
+        }
+        pos_ += literal.size();
+        return true;
+    }
+
+    void SkipSpaces() {
+        while (pos_ < text_.size() && IsSpace(text_[pos_])) {
+            ++pos_;
+        }
+    }
+
+    bool Consume(char c) {
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    void Expect(char c) {
+        SkipSpaces();
+        if (!Consume(c)) {
+            Fail("'"s + c + "' expected"s);
+        }
+    }
+
+    [[noreturn]] void Fail(std::string_view message) const {
+        throw ParsingError("JSON: "s + std::string(message) + " at offset "s + std::to_string(pos_));
+    }
+
+    std::string_view text_;
+    size_t pos_ = 0;
+    size_t depth_ = 0;  // number of arrays and objects around pos_
+    size_t default_degree_;
+};
+
+// parses number from the line and skips separators after it
+std::optional<double> ParseCsvNumber(std::string_view& line) {
+    double value = 0;
+    const auto [ptr, ec] = std::from_chars(line.data(), line.data() + line.size(), value);
+    if (ec != std::errc{} || ptr == line.data() || !std::isfinite(value)) {
+        return std::nullopt;
+    }
+    line.remove_prefix(ptr - line.data());
+
+    const size_t next = line.find_first_not_of(",; \t\r"sv);
+    line.remove_prefix(next == std::string_view::npos ? line.size() : next);
+    return value;
+}
+
+std::optional<Data> ParseCsvLine(std::string_view line) {
+    const auto x = ParseCsvNumber(line);
+    if (!x) {
+        return std::nullopt;
+    }
+    const auto y = ParseCsvNumber(line);
+    if (!y || !line.empty()) {
+        return std::nullopt;
+    }
+    return Data{*x, *y};
+}
+
+}  // namespace
+
+// reads the whole stream into the string
+std::string ReadAll(std::istream& in) {
+    std::string text;
+    const size_t chunk_size = 1 << 16;
+    size_t size = 0;
+    do {
+        text.resize(size + chunk_size);
+        in.read(text.data() + size, chunk_size);
+        size += static_cast<size_t>(in.gcount());
+    } while (in);
+    text.resize(size);
+    return text;
+}
+
+std::vector<FitRequest> ReadJson(std::string_view text, size_t default_degree) {
+    return JsonParser(text, default_degree).ParseRoot();
+}
+
+std::vector<Data> ReadCsv(std::string_view text) {
+    std::vector<Data> data;
+    bool first_line = true;
+    size_t line_number = 0;
+
+    while (!text.empty()) {
+        const size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        ++line_number;
+
+        const size_t begin = line.find_first_not_of(" \t\r"sv);
+        if (begin == std::string_view::npos || line[begin] == '#') {
+            continue;
+        }
+        line.remove_prefix(begin);
+
+        if (const auto point = ParseCsvLine(line)) {
+            data.push_back(*point);
+        } else if (!first_line) {
+            throw ParsingError("CSV: pair of numbers expected at line "s + std::to_string(line_number));
+        }
+        first_line = false;
+    }
+    return data;
+}
+
+ServerRequest ReadServerRequest(std::string_view line, size_t default_degree) {
+    return JsonParser(line, default_degree).ParseServerRequest();
+}
+
+std::vector<FitRequest> ReadRequests(std::string_view text, size_t default_degree) {
+    PROFILE_SCOPE("io::ReadRequests");
+    ALLOC_STAGE("parse");
+    PROFILE_COUNTER("input bytes", text.size());
+    const size_t begin = text.find_first_not_of(" \t\r\n"sv);
+    if (begin != std::string_view::npos && (text[begin] == '{' || text[begin] == '[')) {
+        return ReadJson(text, default_degree);
+    }
+
+    FitRequest request;
+    request.degree = default_degree;
+    request.data = ReadCsv(text);
+    if (const auto error = CheckRequest(request)) {
+        throw ParsingError("CSV: "s + *error);
+    }
+    return {std::move(request)};
+}
+
+}  // namespace io
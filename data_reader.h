@@ -0,0 +1,60 @@
+#pragma once
+
+#include "approximator.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace io {
+
+class ParsingError : public std::runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+// max degree of the requested polynomial, higher degrees are meaningless for least squares
+// and make the system of equations too large
+inline constexpr size_t MAX_DEGREE = 30;
+
+// data set that needs to be approximated by the polynomial of the degree
+struct FitRequest {
+    std::string name;
+    size_t degree = 2;
+    std::vector<Data> data;
+};
+
+// request of the fit server
+struct ServerRequest {
+    std::string command;  // "fit", "evaluate" or "render"
+    FitRequest fit;  // name of the fit, degree and data
+    std::vector<double> x;  // arguments to evaluate
+};
+
+// reads the whole stream into the string
+std::string ReadAll(std::istream& in);
+
+// reads requests from JSON: a request object or an array of request objects
+// {"name": "density", "degree": 2, "data": [[x, y], {"x": x, "y": y}, ...]}
+// name and degree are optional, unknown keys are skipped
+// throws ParsingError if the text is not a valid JSON of this form, if a number is not finite,
+// if the data is empty or if the degree is above MAX_DEGREE or not below the number of points
+std::vector<FitRequest> ReadJson(std::string_view text, size_t default_degree);
+
+// reads x and y pairs separated by ',', ';', tabs or spaces, one pair per line
+// empty lines and lines starting with '#' are skipped, the first line may be a header
+// throws ParsingError if a line is not a pair of finite numbers
+std::vector<Data> ReadCsv(std::string_view text);
+
+// reads server request from JSON object with "command" and "x" keys and keys of the fit request
+// throws ParsingError if the line is not a valid JSON object, if a number is not finite,
+// if the degree is above MAX_DEGREE or if the data is given and the degree is not below the number of points
+ServerRequest ReadServerRequest(std::string_view line, size_t default_degree);
+
+// reads JSON if the text starts with '{' or '[', otherwise reads CSV as one request
+// the requests are checked as by ReadJson
+std::vector<FitRequest> ReadRequests(std::string_view text, size_t default_degree);
+
+}  // namespace io
@@ -0,0 +1,180 @@
+#include "data_reducer.h"
+#include "alloc_tracker.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+namespace {
+
+const size_t MIN_TABLE_SIZE = 64;
+const size_t NO_GROUP = static_cast<size_t>(-1);
+
+// count and sums of the points of the group shifted by its first point, so the spread doesn't lose precision
+// on large x and y, the sums are in double at least
+template <typename T>
+struct GroupSums {
+    using Sum = std::common_type_t<T, double>;
+
+    size_t count = 0;
+    T shift_x = 0;
+    T shift_y = 0;
+    Sum x = 0;
+    Sum y = 0;
+    Sum xx = 0;
+    Sum xy = 0;
+    Sum yy = 0;
+
+    void Add(T point_x, T point_y) {
+        if (count == 0) {
+            shift_x = point_x;
+            shift_y = point_y;
+        }
+        ++count;
+        const Sum dx = static_cast<Sum>(point_x) - shift_x;
+        const Sum dy = static_cast<Sum>(point_y) - shift_y;
+        x += dx;
+        y += dy;
+        xx += dx * dx;
+        xy += dx * dy;
+        yy += dy * dy;
+    }
+
+    T GetMeanX() const {
+        return static_cast<T>(shift_x + x / static_cast<Sum>(count));
+    }
+
+    T GetMeanY() const {
+        return static_cast<T>(shift_y + y / static_cast<Sum>(count));
+    }
+
+    // sum of squared deviations of y from the least squares line of the group
+    long double GetSpread() const {
+        const long double n = static_cast<long double>(count);
+        const long double deviation_xx = xx - static_cast<long double>(x) * x / n;
+        const long double deviation_xy = xy - static_cast<long double>(x) * y / n;
+        const long double deviation_yy = yy - static_cast<long double>(y) * y / n;
+        const long double spread = deviation_xx > 0
+            ? deviation_yy - deviation_xy * deviation_xy / deviation_xx : deviation_yy;
+        return std::max(spread, 0.0L);
+    }
+};
+
+template <typename T>
+void AddGroup(BasicReducedData<T>& res, const GroupSums<T>& group) {
+    res.points.push_back({group.GetMeanX(), group.GetMeanY()});
+    res.weights.push_back(static_cast<T>(group.count));
+    res.spread += group.GetSpread();
+}
+
+// the table of groups is rebuilt twice larger when it is half full
+template <typename T>
+std::vector<size_t> GetTable(const std::vector<GroupSums<T>>& groups, size_t size) {
+    std::vector<size_t> table(size, NO_GROUP);
+    for (size_t i = 0; i < groups.size(); ++i) {
+        size_t slot = std::hash<T>{}(groups[i].shift_x);
+        for (;; ++slot) {
+            slot &= size - 1;
+            if (table[slot] == NO_GROUP) {
+                table[slot] = i;
+                break;
+            }
+        }
+    }
+    return table;
+}
+
+template <typename T>
+bool IsSortedByX(const std::vector<BasicData<T>>& data) {
+    return std::is_sorted(data.begin(), data.end(), [](BasicData<T> lhs, BasicData<T> rhs) {
+        return lhs.x < rhs.x;
+    });
+}
+
+// groups of equal x, runs of sorted data are merged at once, other data by the hash table of groups
+template <typename T>
+void ReduceDuplicates(const std::vector<BasicData<T>>& data, BasicReducedData<T>& res) {
+    if (IsSortedByX(data)) {
+        GroupSums<T> group;
+        for (size_t i = 0; i < data.size(); ++i) {
+            if (i > 0 && data[i].x != data[i - 1].x) {
+                AddGroup(res, group);
+                group = {};
+            }
+            group.Add(data[i].x, data[i].y);
+        }
+        AddGroup(res, group);
+        return;
+    }
+
+    // open addressing table of group indexes by x, groups are few, so the table stays in cache
+    std::vector<GroupSums<T>> groups;
+    std::vector<size_t> table(MIN_TABLE_SIZE, NO_GROUP);
+    for (const BasicData<T>& point : data) {
+        size_t slot = std::hash<T>{}(point.x);
+        for (;; ++slot) {
+            slot &= table.size() - 1;
+            if (table[slot] == NO_GROUP || groups[table[slot]].shift_x == point.x) {
+                break;
+            }
+        }
+        if (table[slot] != NO_GROUP) {
+            groups[table[slot]].Add(point.x, point.y);
+            continue;
+        }
+        table[slot] = groups.size();
+        groups.emplace_back().Add(point.x, point.y);
+        if (2 * groups.size() > table.size()) {
+            table = GetTable(groups, table.size() * 2);
+        }
+    }
+    std::sort(groups.begin(), groups.end(), [](const GroupSums<T>& lhs, const GroupSums<T>& rhs) {
+        return lhs.shift_x < rhs.shift_x;
+    });
+    for (const GroupSums<T>& group : groups) {
+        AddGroup(res, group);
+    }
+}
+
+template <typename T>
+void ReduceBins(const std::vector<BasicData<T>>& data, size_t bins_count, BasicReducedData<T>& res) {
+    const auto [min_x, max_x] = GetRangeX(data);
+    bins_count = std::max<size_t>(bins_count, 1);
+    std::vector<GroupSums<T>> bins(bins_count);
+    const long double scale = max_x > min_x ? bins_count / (static_cast<long double>(max_x) - min_x) : 0;
+    for (const BasicData<T>& point : data) {
+        const size_t bin = static_cast<size_t>((static_cast<long double>(point.x) - min_x) * scale);
+        bins[std::min(bin, bins_count - 1)].Add(point.x, point.y);
+    }
+    for (const GroupSums<T>& bin : bins) {
+        if (bin.count > 0) {
+            AddGroup(res, bin);
+        }
+    }
+}
+
+}  // namespace
+
+template <typename T>
+BasicReducedData<T> ReduceData(const std::vector<BasicData<T>>& data, const ReductionSettings& settings) {
+    PROFILE_SCOPE("ReduceData");
+    ALLOC_STAGE("fit/reduce");
+    PROFILE_COUNTER("points", data.size());
+    BasicReducedData<T> res;
+    res.count = data.size();
+    if (data.empty()) {
+        return res;
+    }
+    if (settings.mode == ReductionMode::BINS) {
+        ReduceBins(data, settings.bins_count, res);
+    } else {
+        ReduceDuplicates(data, res);
+    }
+    return res;
+}
+
+template BasicReducedData<float> ReduceData<float>(const std::vector<BasicData<float>>&, const ReductionSettings&);
+template BasicReducedData<double> ReduceData<double>(const std::vector<BasicData<double>>&, const ReductionSettings&);
+template BasicReducedData<long double> ReduceData<long double>(const std::vector<BasicData<long double>>&,
+                                                               const ReductionSettings&);
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "approximator.h"
+
+#include <vector>
+
+// how points are merged into weighted points before the fit
+enum class ReductionMode {
+    DUPLICATES,  // points with equal x, the least squares fit doesn't change
+    BINS  // points in bins of equal width over the range of x, the group is placed at the mean x of its points
+};
+
+struct ReductionSettings {
+    ReductionMode mode = ReductionMode::DUPLICATES;
+    size_t bins_count = 4096;  // number of bins in BINS mode
+};
+
+// points merged into groups: the fit by weighted least squares with the numbers of points as weights
+// has the same system of equations as the fit of all points, so its cost depends on the number of groups
+template <typename T>
+struct BasicReducedData {
+    std::vector<BasicData<T>> points;  // mean x and mean y of the groups sorted by x
+    std::vector<T> weights;  // numbers of points in the groups
+    // sum of squared deviations of y from the means of their groups (from the line through the group in BINS mode),
+    // SSE of all points is the weighted SSE of the groups plus the spread
+    long double spread = 0;
+    size_t count = 0;  // number of points before the reduction
+};
+
+using ReducedData = BasicReducedData<double>;
+
+// merges the points into weighted points in one pass, sorted data is merged without the lookup of groups
+// in BINS mode the data is reduced to at most bins_count points, the fit is then approximate:
+// it loses the spread of x inside the bins
+template <typename T>
+BasicReducedData<T> ReduceData(const std::vector<BasicData<T>>& data, const ReductionSettings& settings = {});
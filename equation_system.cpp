@@ -1,11 +1,16 @@
 #include "equation_system.h"
+#include "alloc_tracker.h"
+#include "profiler.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 // return algebraic addition for element in matrix[row][col]
-double CalcAlgebraicAddition(size_t row, size_t col, const Matrix& matrix) {
+template <typename T>
+T CalcAlgebraicAddition(size_t row, size_t col, const BasicMatrix<T>& matrix) {
     size_t size = matrix.size() - 1;
-    Matrix minor_matrix(size);
+    BasicMatrix<T> minor_matrix(size);
 
     size_t m_i = 0;
     for (size_t i = 0; i < matrix.size(); ++i) {
@@ -21,12 +26,13 @@ double CalcAlgebraicAddition(size_t row, size_t col, const Matrix& matrix) {
         }
         ++m_i;
     }
-    int coef = (row + col) % 2 == 0 ? 1 : -1;
+    T coef = (row + col) % 2 == 0 ? 1 : -1;
     return coef * GetDeterminant(minor_matrix);
 }
 
 // calc determinant of matrix
-double GetDeterminant(const Matrix& matrix) {
+template <typename T>
+T GetDeterminant(const BasicMatrix<T>& matrix) {
     size_t order = matrix.size();  // order of matrix;
     if (order == 1) {
         return matrix[0][0];
@@ -36,7 +42,7 @@ double GetDeterminant(const Matrix& matrix) {
         return matrix[0][0] * matrix[1][1] - matrix[0][1] * matrix[1][0];
     }
 
-    double det = 0;
+    T det = 0;
     for (size_t i = 0; i < matrix.size(); ++i) {
         det += matrix[0][i] * CalcAlgebraicAddition(0, i, matrix);
     }
@@ -44,9 +50,10 @@ double GetDeterminant(const Matrix& matrix) {
 }
 
 // return inverse matrix
-Matrix GetInverseMatrix(const Matrix& matrix, double det) {
+template <typename T>
+BasicMatrix<T> GetInverseMatrix(const BasicMatrix<T>& matrix, T det) {
     size_t size = matrix.size();
-    Matrix inverse_matrix(size, std::vector<double>(size));
+    BasicMatrix<T> inverse_matrix(size, std::vector<T>(size));
 
     for (size_t i = 0; i < size; ++i) { // change row
         for (size_t j = 0; j < size; ++j) { // change col
@@ -57,12 +64,13 @@ Matrix GetInverseMatrix(const Matrix& matrix, double det) {
 }
 
 // multiply square matrix n*n and vector with n elements
-std::vector<double> MultiplyMatrix(const Matrix& matrix, const std::vector<double>& vec) {
+template <typename T>
+std::vector<T> MultiplyMatrix(const BasicMatrix<T>& matrix, const std::vector<T>& vec) {
     size_t size = vec.size();
-    std::vector<double> res(size);
+    std::vector<T> res(size);
 
     for (size_t i = 0; i < size; ++i) {
-        double t = 0;
+        T t = 0;
         for (size_t j = 0; j < size; ++j) {
             t += matrix[i][j] * vec[j];
         }
@@ -71,13 +79,115 @@ std::vector<double> MultiplyMatrix(const Matrix& matrix, const std::vector<doubl
     return res;
 }
 
+// ********** methods of class LuFactorization  ************
+template <typename T>
+std::optional<LuFactorization<T>> LuFactorization<T>::Factor(BasicMatrix<T> matrix) {
+    const size_t size = matrix.size();
+    std::vector<size_t> permutation(size);
+    for (size_t i = 0; i < size; ++i) {
+        permutation[i] = i;
+    }
+
+    for (size_t col = 0; col < size; ++col) {
+        // the biggest element of the column goes to the diagonal
+        size_t pivot_row = col;
+        for (size_t row = col + 1; row < size; ++row) {
+            if (std::abs(matrix[row][col]) > std::abs(matrix[pivot_row][col])) {
+                pivot_row = row;
+            }
+        }
+        if (matrix[pivot_row][col] == 0) {
+            return std::nullopt;
+        }
+        std::swap(matrix[col], matrix[pivot_row]);
+        std::swap(permutation[col], permutation[pivot_row]);
+
+        const T pivot = matrix[col][col];
+        for (size_t row = col + 1; row < size; ++row) {
+            const T factor = matrix[row][col] / pivot;
+            matrix[row][col] = factor;
+            for (size_t j = col + 1; j < size; ++j) {
+                matrix[row][j] -= factor * matrix[col][j];
+            }
+        }
+    }
+    return LuFactorization(std::move(matrix), std::move(permutation));
+}
+
+template <typename T>
+std::vector<T> LuFactorization<T>::Solve(std::vector<T> right_part) const {
+    const size_t size = lu_.size();
+    std::vector<T> res(size);
+
+    // L * y = P * b
+    for (size_t i = 0; i < size; ++i) {
+        T value = right_part[permutation_[i]];
+        for (size_t j = 0; j < i; ++j) {
+            value -= lu_[i][j] * res[j];
+        }
+        res[i] = value;
+    }
+    // U * x = y
+    for (size_t i = size; i-- > 0;) {
+        T value = res[i];
+        for (size_t j = i + 1; j < size; ++j) {
+            value -= lu_[i][j] * res[j];
+        }
+        res[i] = value / lu_[i][i];
+    }
+    return res;
+}
+
+template <typename T>
+BasicMatrix<T> LuFactorization<T>::GetInverse() const {
+    const size_t size = lu_.size();
+    BasicMatrix<T> inverse_matrix(size, std::vector<T>(size));
+
+    std::vector<T> unit(size);
+    for (size_t j = 0; j < size; ++j) {
+        unit[j] = 1;
+        const std::vector<T> col = Solve(unit);
+        unit[j] = 0;
+        for (size_t i = 0; i < size; ++i) {
+            inverse_matrix[i][j] = col[i];
+        }
+    }
+    return inverse_matrix;
+}
+
+namespace {
+// maximum of sums of absolute values in the columns
+template <typename T>
+T GetNorm1(const BasicMatrix<T>& matrix) {
+    T norm = 0;
+    for (size_t j = 0; j < matrix.size(); ++j) {
+        T sum = 0;
+        for (const auto& row : matrix) {
+            sum += std::abs(row[j]);
+        }
+        norm = std::max(norm, sum);
+    }
+    return norm;
+}
+
+template <typename T>
+T GetMaxNorm(const std::vector<T>& vec) {
+    T norm = 0;
+    for (T value : vec) {
+        norm = std::max(norm, std::abs(value));
+    }
+    return norm;
+}
+}  // namespace
+
 // ********** methods of class EquationSystem  ************
 // solve matrix equation by the Gauss method
-void EquationSystem::SolveByTheGauss() const {
+template <typename T>
+void BasicEquationSystem<T>::SolveByTheGauss() const {
     size_t size = matrix_.size();
 
     for (size_t i = 0; i < size; ++i) {
-        double first_item = matrix_[i][i];
+        T first_item = matrix_[i][i];
         assert(first_item);
 
         // we divide the equation by the first element to get one in the first element
@@ -103,12 +213,15 @@ void EquationSystem::SolveByTheGauss() const {
 
 
 // calc system of equations and return solution
-std::optional<std::vector<double>> EquationSystem::GetSolve() const {
-    std::vector<double> res;
+template <typename T>
+std::optional<std::vector<T>> BasicEquationSystem<T>::GetSolve() const {
+    PROFILE_SCOPE("EquationSystem::GetSolve");
+    ALLOC_STAGE("fit/solve");
+    std::vector<T> res;
     res.reserve(matrix_.size());
 
-    const double det = GetDeterminant(matrix_);
-    if (!det) {
+    // the pivots of LU show a singular matrix in O(n^3), the determinant by cofactors takes O(n!)
+    if (!LuFactorization<T>::Factor(matrix_)) {
         return std::nullopt;
     }
 
@@ -120,4 +233,79 @@ std::optional<std::vector<double>> EquationSystem::GetSolve() const {
 
     return res;
     //return std::move(right_part_);
-}
\ No newline at end of file
+}
+
+// factors the matrix in precision T, computes residuals in long double and corrects the solution
+template <typename T>
+std::optional<RefinedSolution<T>> BasicEquationSystem<T>::GetRefinedSolve(T tolerance, size_t max_iterations) const {
+    // elements of A and b are exact in long double
+    BasicMatrix<long double> exact_matrix(matrix_.size());
+    for (size_t i = 0; i < matrix_.size(); ++i) {
+        exact_matrix[i].assign(matrix_[i].begin(), matrix_[i].end());
+    }
+    return GetRefinedSolve(exact_matrix, std::vector<long double>(right_part_.begin(), right_part_.end()),
+                           tolerance, max_iterations);
+}
+
+// factors the matrix in precision T, computes residuals of the long double system and corrects the solution
+template <typename T>
+std::optional<RefinedSolution<T>> BasicEquationSystem<T>::GetRefinedSolve(const BasicMatrix<long double>& exact_matrix,
+                                                                          const std::vector<long double>& exact_right_part,
+                                                                          T tolerance, size_t max_iterations) const {
+    PROFILE_SCOPE("EquationSystem::GetRefinedSolve");
+    ALLOC_STAGE("fit/solve");
+    using Extended = long double;
+
+    const auto lu = LuFactorization<T>::Factor(matrix_);
+    if (!lu) {
+        return std::nullopt;
+    }
+
+    RefinedSolution<T> res;
+    res.solution = lu->Solve(right_part_);
+    res.inverse = lu->GetInverse();
+    res.condition = GetNorm1(matrix_) * GetNorm1(res.inverse);
+
+    const size_t size = matrix_.size();
+    std::vector<T> residual(size);
+    T prev_correction = std::numeric_limits<T>::infinity();
+    while (res.iterations < max_iterations) {
+        // r = b - A * x of the long double system
+        for (size_t i = 0; i < size; ++i) {
+            Extended value = exact_right_part[i];
+            for (size_t j = 0; j < size; ++j) {
+                value -= exact_matrix[i][j] * res.solution[j];
+            }
+            residual[i] = static_cast<T>(value);
+        }
+
+        const std::vector<T> correction = lu->Solve(residual);
+        const T solution_norm = GetMaxNorm(res.solution);
+        res.correction = solution_norm > 0 ? GetMaxNorm(correction) / solution_norm : GetMaxNorm(correction);
+        // the correction which doesn't decrease means that the matrix is too ill-conditioned for precision T
+        if (!(res.correction < prev_correction)) {
+            break;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            res.solution[i] += correction[i];
+        }
+        ++res.iterations;
+        if (res.correction <= tolerance) {
+            break;
+        }
+        prev_correction = res.correction;
+    }
+    return res;
+}
+
+#define INSTANTIATE_EQUATION_SYSTEM(T) \
+    template T CalcAlgebraicAddition<T>(size_t, size_t, const BasicMatrix<T>&); \
+    template T GetDeterminant<T>(const BasicMatrix<T>&); \
+    template BasicMatrix<T> GetInverseMatrix<T>(const BasicMatrix<T>&, T); \
+    template std::vector<T> MultiplyMatrix<T>(const BasicMatrix<T>&, const std::vector<T>&); \
+    template class LuFactorization<T>; \
+    template class BasicEquationSystem<T>
+
+INSTANTIATE_EQUATION_SYSTEM(float);
+INSTANTIATE_EQUATION_SYSTEM(double);
+INSTANTIATE_EQUATION_SYSTEM(long double);
@@ -1,29 +1,101 @@
 #pragma once
 
+#include <limits>
 #include <optional>
 #include <vector>
 
-using Matrix = std::vector<std::vector<double>>;
+// all templates are explicitly instantiated for float, double and long double in equation_system.cpp
+
+template <typename T>
+using BasicMatrix = std::vector<std::vector<T>>;
+using Matrix = BasicMatrix<double>;
 
 // return algebraic addition for element in matrix[row][col]
-double CalcAlgebraicAddition(size_t row, size_t col, const Matrix& matrix);
+template <typename T>
+T CalcAlgebraicAddition(size_t row, size_t col, const BasicMatrix<T>& matrix);
 // calc determinant of matrix
-double GetDeterminant(const Matrix& matrix);
+template <typename T>
+T GetDeterminant(const BasicMatrix<T>& matrix);
 // return inverse matrix
-Matrix GetInverseMatrix(const Matrix& matrix, double det);
+template <typename T>
+BasicMatrix<T> GetInverseMatrix(const BasicMatrix<T>& matrix, T det);
 // multiply square matrix n*n and vector with n elements
-std::vector<double> MultiplyMatrix(const Matrix& matrix, const std::vector<double>& vec);
+template <typename T>
+std::vector<T> MultiplyMatrix(const BasicMatrix<T>& matrix, const std::vector<T>& vec);
+
+// LU decomposition with partial pivoting: P * A = L * U, costs O(n^3)
+template <typename T>
+class LuFactorization {
+public:
+    // returns nullopt if the matrix is singular in precision T
+    static std::optional<LuFactorization> Factor(BasicMatrix<T> matrix);
+
+    // solves A * x = right_part with the factors, costs O(n^2)
+    std::vector<T> Solve(std::vector<T> right_part) const;
+    // returns inverse matrix solving for columns of the identity matrix, costs O(n^3)
+    BasicMatrix<T> GetInverse() const;
+
+    size_t GetSize() const {
+        return lu_.size();
+    }
+
+private:
+    LuFactorization(BasicMatrix<T> lu, std::vector<size_t> permutation)
+        : lu_{std::move(lu)},
+          permutation_{std::move(permutation)} {
+    }
+
+    // L below the diagonal (with ones on the diagonal) and U on and above it
+    BasicMatrix<T> lu_;
+    // permutation_[i] is the row of A which moved to row i
+    std::vector<size_t> permutation_;
+};
+
+// solution refined by iterations
+template <typename T>
+struct RefinedSolution {
+    std::vector<T> solution;
+    // number of corrections after the first solve
+    size_t iterations = 0;
+    // estimate of the condition number of the matrix in 1-norm
+    T condition = 0;
+    // size of the last correction relative to the solution in max-norm
+    T correction = 0;
+    // inverse matrix from the factorization
+    BasicMatrix<T> inverse;
+};
 
 // system of equations
-class EquationSystem {
+template <typename T>
+class BasicEquationSystem {
 public:
-    explicit EquationSystem(Matrix matrix, std::vector<double> right_part) 
+    explicit BasicEquationSystem(BasicMatrix<T> matrix, std::vector<T> right_part) 
         : matrix_{std::move(matrix)},
           right_part_{std::move(right_part)} {
     }
 
+    const BasicMatrix<T>& GetMatrix() const {
+        return matrix_;
+    }
+    const std::vector<T>& GetRightPart() const {
+        return right_part_;
+    }
+
     // calc system of equations and return solution
-    std::optional<std::vector<double>> GetSolve() const;
+    std::optional<std::vector<T>> GetSolve() const;
+
+    // factors the matrix in precision T, computes residuals in long double and corrects the solution
+    // until the correction is less than tolerance relative to the solution or stops decreasing
+    // returns nullopt if the matrix is singular, must not be called after GetSolve which changes the system
+    std::optional<RefinedSolution<T>> GetRefinedSolve(T tolerance = std::numeric_limits<T>::epsilon(),
+                                                      size_t max_iterations = 10) const;
+    // the same, but the residuals are computed with the system given in long double,
+    // e.g. the sums accumulated in long double before they were rounded to T:
+    // the solution then converges to the solution of that system, not of the rounded one
+    std::optional<RefinedSolution<T>> GetRefinedSolve(const BasicMatrix<long double>& exact_matrix,
+                                                      const std::vector<long double>& exact_right_part,
+                                                      T tolerance = std::numeric_limits<T>::epsilon(),
+                                                      size_t max_iterations = 10) const;
 
 private:
     // solve matrix equation by the Gauss method
@@ -31,6 +103,8 @@ private:
 
     // matrix_ stores vectors with raws elements
     // matrix_[0] match to the first raw
-    mutable Matrix matrix_;
-    mutable std::vector<double> right_part_;
-};
\ No newline at end of file
+    mutable BasicMatrix<T> matrix_;
+    mutable std::vector<T> right_part_;
+};
+
+using EquationSystem = BasicEquationSystem<double>;
@@ -0,0 +1,181 @@
+#include "fit_report.h"
+#include "alloc_tracker.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// number of points of the block of the data pass, the block stays in L1 cache
+const size_t BLOCK_SIZE = 256;
+// number of copies of the histogram, neighbouring residuals in the same bin don't wait for each other's increments
+const size_t HISTOGRAM_COPIES = 4;
+
+template <typename T>
+T GetRSquared(long double sse, long double total) {
+    if (total > 0) {
+        return static_cast<T>(1 - sse / total);
+    }
+    return sse == 0 ? T{1} : T{0};
+}
+
+// adds residuals to the copies of the histogram of bins_count bins scaled by the rmse,
+// residuals out of the range go to the edge bins
+template <typename T>
+void AddToHistogram(std::vector<size_t>& copies, size_t bins_count, const T* residuals, size_t count, T rmse) {
+    if (!(rmse > 0)) {
+        copies[bins_count / 2] += count;
+        return;
+    }
+    // position of the residual in bins is residual * factor + offset
+    const T factor = static_cast<T>(bins_count) / (static_cast<T>(2 * HISTOGRAM_RANGE) * rmse);
+    const T offset = static_cast<T>(bins_count) / 2;
+    const T last = static_cast<T>(bins_count - 1);
+    for (size_t i = 0; i < count; ++i) {
+        const T position = std::clamp(residuals[i] * factor + offset, T{0}, last);
+        // NaN residuals go to the first bin
+        const size_t bin = position >= 0 ? static_cast<size_t>(position) : 0;
+        ++copies[(i % HISTOGRAM_COPIES) * bins_count + bin];
+    }
+}
+
+}  // namespace
+
+template <typename T>
+std::optional<BasicFitReport<T>> GetFitReport(const BasicMoments<T>& moments, const BasicPolynomial<T>& polynom) {
+    const size_t size = polynom.coeffs.size();
+    if (moments.count == 0 || moments.matrix.size() != size || moments.right_part.size() != size) {
+        return std::nullopt;
+    }
+
+    // a^T * b and a^T * G * a with the sums of absolute values for the bound of the rounding error
+    long double ab = 0;
+    long double abs_ab = 0;
+    long double aga = 0;
+    long double abs_aga = 0;
+    for (size_t i = 0; i < size; ++i) {
+        const long double a = polynom.coeffs[i];
+        ab += a * moments.right_part[i];
+        abs_ab += std::abs(a * moments.right_part[i]);
+        long double row = 0;
+        long double abs_row = 0;
+        for (size_t j = 0; j < size; ++j) {
+            row += moments.matrix[i][j] * static_cast<long double>(polynom.coeffs[j]);
+            abs_row += std::abs(moments.matrix[i][j] * static_cast<long double>(polynom.coeffs[j]));
+        }
+        aga += a * row;
+        abs_aga += std::abs(a) * abs_row;
+    }
+
+    // the sums of G and b are accumulated over all points, so their rounding grows with the number of points
+    const long double sse = moments.sum_yy - 2 * ab + aga;
+    const long double rounding = 4 * static_cast<long double>(size + moments.count)
+        * std::numeric_limits<T>::epsilon() * (moments.sum_yy + 2 * abs_ab + abs_aga);
+    if (!(sse > rounding)) {
+        return std::nullopt;
+    }
+
+    const long double count = static_cast<long double>(moments.count);
+    const long double sum_y = moments.right_part[0];
+    BasicFitReport<T> report;
+    report.points_count = moments.count;
+    report.sse = static_cast<T>(sse);
+    report.r_squared = GetRSquared<T>(sse, moments.sum_yy - sum_y * sum_y / count);
+    report.rmse = static_cast<T>(std::sqrt(sse / count));
+    report.from_moments = true;
+    return report;
+}
+
+template <typename T>
+BasicFitReport<T> GetFitReport(const BasicPolynomial<T>& polynom, const std::vector<BasicData<T>>& data,
+                               size_t histogram_bins, T rmse_hint) {
+    PROFILE_SCOPE("GetFitReport");
+    ALLOC_STAGE("fit/report");
+    PROFILE_COUNTER("points", data.size());
+    BasicFitReport<T> report;
+    report.points_count = data.size();
+    report.histogram.assign(histogram_bins, 0);
+    if (data.empty()) {
+        return report;
+    }
+    std::vector<size_t> histogram_copies(HISTOGRAM_COPIES * histogram_bins, 0);
+
+    const bool keep_residuals = histogram_bins > 0 && !(rmse_hint > 0);
+    std::vector<T> residuals;
+    if (keep_residuals) {
+        residuals.reserve(data.size());
+    }
+
+    // y are shifted by the first y, so the sum of squares about the mean doesn't lose precision on large y
+    const T shift = data.front().y;
+    long double sse = 0;
+    long double sum_shifted = 0;
+    long double sum_shifted_squares = 0;
+    T max_residual = 0;
+
+    T x[BLOCK_SIZE];
+    T y[BLOCK_SIZE];
+    T residual[BLOCK_SIZE];
+    for (size_t begin = 0; begin < data.size(); begin += BLOCK_SIZE) {
+        const size_t count = std::min(BLOCK_SIZE, data.size() - begin);
+        for (size_t i = 0; i < count; ++i) {
+            x[i] = data[begin + i].x;
+            y[i] = data[begin + i].y;
+            residual[i] = 0;
+        }
+        // values of the polynomial, the loop over points is vectorised
+        for (size_t k = polynom.coeffs.size(); k-- > 0;) {
+            const T coeff = polynom.coeffs[k];
+            for (size_t i = 0; i < count; ++i) {
+                residual[i] = residual[i] * x[i] + coeff;
+            }
+        }
+
+        T block_sse = 0;
+        T block_shifted = 0;
+        T block_shifted_squares = 0;
+        T block_max = 0;
+        for (size_t i = 0; i < count; ++i) {
+            residual[i] = y[i] - residual[i];
+            block_sse += residual[i] * residual[i];
+            const T shifted = y[i] - shift;
+            block_shifted += shifted;
+            block_shifted_squares += shifted * shifted;
+            block_max = std::max(block_max, std::abs(residual[i]));
+        }
+        sse += block_sse;
+        sum_shifted += block_shifted;
+        sum_shifted_squares += block_shifted_squares;
+        max_residual = std::max(max_residual, block_max);
+
+        if (keep_residuals) {
+            residuals.insert(residuals.end(), residual, residual + count);
+        } else if (histogram_bins > 0) {
+            AddToHistogram(histogram_copies, histogram_bins, residual, count, rmse_hint);
+        }
+    }
+
+    const long double points_count = static_cast<long double>(data.size());
+    report.sse = static_cast<T>(sse);
+    report.r_squared = GetRSquared<T>(sse, sum_shifted_squares - sum_shifted * sum_shifted / points_count);
+    report.rmse = static_cast<T>(std::sqrt(sse / points_count));
+    report.max_residual = max_residual;
+    if (keep_residuals) {
+        AddToHistogram(histogram_copies, histogram_bins, residuals.data(), residuals.size(), report.rmse);
+    }
+    for (size_t i = 0; i < histogram_copies.size(); ++i) {
+        report.histogram[i % histogram_bins] += histogram_copies[i];
+    }
+    return report;
+}
+
+#define INSTANTIATE_FIT_REPORT(T) \
+    template std::optional<BasicFitReport<T>> GetFitReport<T>(const BasicMoments<T>&, const BasicPolynomial<T>&); \
+    template BasicFitReport<T> GetFitReport<T>(const BasicPolynomial<T>&, const std::vector<BasicData<T>>&, \
+                                               size_t, T)
+
+INSTANTIATE_FIT_REPORT(float);
+INSTANTIATE_FIT_REPORT(double);
+INSTANTIATE_FIT_REPORT(long double);
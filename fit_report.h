@@ -0,0 +1,42 @@
+#pragma once
+
+#include "approximator.h"
+
+#include <optional>
+#include <vector>
+
+// residuals of the histogram are binned over [-HISTOGRAM_RANGE * rmse, HISTOGRAM_RANGE * rmse],
+// the edge bins also count the tails
+inline constexpr double HISTOGRAM_RANGE = 4;
+
+// quality of the fit of the polynomial
+template <typename T>
+struct BasicFitReport {
+    size_t points_count = 0;
+    T sse = 0;  // sum of squared errors
+    T r_squared = 0;  // 1 - SSE / sum((y - mean(y))^2), 1 for constant y fitted exactly
+    T rmse = 0;  // sqrt(SSE / points_count)
+    // filled only by the pass over the data
+    std::optional<T> max_residual;  // max |y - p(x)|
+    std::vector<size_t> histogram;  // counts of residuals y - p(x) in equal bins, see HISTOGRAM_RANGE
+    // true if the report is calculated from the sums of the fit without the data
+    bool from_moments = false;
+};
+
+using FitReport = BasicFitReport<double>;
+
+// diagnostics from the sums of the fit in long double: SSE = sum(y^2) - 2 * a^T * b + a^T * G * a,
+// the sum of squares about the mean is sum(y^2) - sum(y)^2 / m
+// the formula is exact for any coefficients a, but the sums G and b are accumulated over m points and rounded to T,
+// so returns nullopt if SSE is below the rounding error bound of order (n + m) * eps(T) * sum(y^2)
+template <typename T>
+std::optional<BasicFitReport<T>> GetFitReport(const BasicMoments<T>& moments, const BasicPolynomial<T>& polynom);
+
+// diagnostics by one pass over the data: the data is processed by blocks, values of the polynomial
+// are calculated for the whole block by Horner's method in vectorised loops, then residuals of the block
+// update sums, the max residual and the histogram of histogram_bins bins at once
+// the histogram is scaled by rmse_hint (e.g. from the moments), if it is 0 the residuals are kept
+// and binned after the pass by the rmse of the pass
+template <typename T>
+BasicFitReport<T> GetFitReport(const BasicPolynomial<T>& polynom, const std::vector<BasicData<T>>& data,
+                               size_t histogram_bins = 0, T rmse_hint = 0);
@@ -0,0 +1,371 @@
+#include "fit_server.h"
+
+#include "approximator_manager.h"
+#include "fit_report.h"
+#include "result_writer.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <queue>
+#include <sstream>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <map>
+#define FIT_SERVER_UNIX_SOCKET
+#endif
+
+using namespace std::literals;
+
+FitServer::FitServer(const renderer::RenderSettings& settings, size_t default_degree, size_t threads_count)
+        : renderer_{settings},
+          default_degree_{default_degree},
+          threads_count_{threads_count ? threads_count : std::max(1u, std::thread::hardware_concurrency())} {
+}
+
+// handles one request line and returns the answer line
+std::string FitServer::HandleRequest(std::string_view line) {
+    try {
+        io::ServerRequest request = io::ReadServerRequest(line, default_degree_);
+        if (request.command == "fit"sv) {
+            return HandleFit(request.fit);
+        }
+        if (request.command == "evaluate"sv) {
+            return HandleEvaluate(request.fit.name, request.x);
+        }
+        if (request.command == "render"sv) {
+            return HandleRender(request.fit.name);
+        }
+        return io::ErrorToJson("unknown command \""s + request.command + "\""s);
+    } catch (const io::ParsingError& e) {
+        return io::ErrorToJson(e.what());
+    } catch (const std::exception& e) {
+        // e.g. bad_alloc of a huge request, the server keeps serving other requests
+        return io::ErrorToJson("request failed: "s + e.what());
+    }
+}
+
+std::string FitServer::HandleFit(io::FitRequest& request) {
+    std::shared_ptr<Fit> fit = FindFit(request.name);
+    if (!fit) {
+        if (request.data.empty()) {
+            return io::ErrorToJson("no data for \""s + request.name + "\""s);
+        }
+        std::unique_lock lock(fits_mutex_);
+        auto& stored = fits_[request.name];
+        if (!stored) {
+            stored = std::make_shared<Fit>();
+        }
+        fit = stored;
+    }
+
+    io::FitResult result;
+    result.name = std::move(request.name);
+    result.degree = request.degree;
+
+    std::lock_guard lock(fit->mutex);
+    if (!request.data.empty()) {
+        // new data resets the cached polynomial
+        fit->app = Approximator();
+        fit->app.SetData(request.data);
+    } else if (request.degree >= fit->app.GetPointsCount()) {
+        return io::ErrorToJson("degree must be less than the number of points"sv);
+    }
+    result.polynom = fit->app.GetPolynom(request.degree);
+    if (const auto report = fit->app.GetFitReport()) {
+        result.sse = report->sse;
+        result.covariance = fit->app.GetCovariance(report->sse);
+    }
+    return io::ToJson(result);
+}
+
+std::string FitServer::HandleEvaluate(std::string_view name, const std::vector<double>& x) {
+    const std::shared_ptr<Fit> fit = FindFit(name);
+    if (!fit) {
+        return io::ErrorToJson("unknown fit \""s + std::string(name) + "\""s);
+    }
+
+    std::optional<Polynomial> polynom;
+    {
+        std::lock_guard lock(fit->mutex);
+        polynom = fit->app.GetLastPolynom();
+    }
+    if (!polynom) {
+        return io::ErrorToJson("polynomial for \""s + std::string(name) + "\" is not found"s);
+    }
+
+    std::vector<double> y(x.size());
+    std::transform(x.begin(), x.end(), y.begin(), *polynom);
+    return io::ValuesToJson(name, y);
+}
+
+std::string FitServer::HandleRender(std::string_view name) {
+    const std::shared_ptr<Fit> fit = FindFit(name);
+    if (!fit) {
+        return io::ErrorToJson("unknown fit \""s + std::string(name) + "\""s);
+    }
+
+    std::ostringstream svg;
+    {
+        std::lock_guard lock(fit->mutex);
+        if (!fit->app.GetLastPolynom()) {
+            return io::ErrorToJson("polynomial for \""s + std::string(name) + "\" is not found"s);
+        }
+        ApproximatorManager(fit->app, renderer_).RenderGraph(svg);
+    }
+    return io::SvgToJson(name, svg.view());
+}
+
+// returns nullptr if there is no fit with the name
+std::shared_ptr<FitServer::Fit> FitServer::FindFit(std::string_view name) const {
+    std::shared_lock lock(fits_mutex_);
+    const auto iter = fits_.find(std::string(name));
+    return iter == fits_.end() ? nullptr : iter->second;
+}
+
+// answers requests from in line by line until the end of the stream
+void FitServer::ServeStream(std::istream& in, std::ostream& out) {
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.find_first_not_of(" \t\r"sv) == std::string::npos) {
+            continue;
+        }
+        out << HandleRequest(line) << std::endl;
+    }
+}
+
+#ifdef FIT_SERVER_UNIX_SOCKET
+
+namespace {
+
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int SEND_FLAGS = 0;
+#endif
+
+// writes all the text to the socket, a closed peer doesn't raise SIGPIPE
+bool SendAll(int socket, std::string_view text) {
+    while (!text.empty()) {
+        const ssize_t written = send(socket, text.data(), text.size(), SEND_FLAGS);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        text.remove_prefix(static_cast<size_t>(written));
+    }
+    return true;
+}
+
+// connected client of the socket
+struct Connection {
+    std::string buffer;  // received text after the last complete line
+    bool busy = false;  // a worker answers the lines of the connection, it is not read until then
+    bool closed = false;  // the peer is gone, the socket is closed when the connection is not busy
+};
+
+// complete lines of the connection passed to a worker
+struct Task {
+    int socket = -1;
+    std::string lines;
+    bool too_long = false;  // the rest of the connection is a line longer than the limit
+};
+
+}  // namespace
+
+// answers all complete lines, each answer is one line
+std::string FitServer::AnswerLines(std::string_view lines) {
+    std::string answers;
+    size_t begin = 0;
+    for (size_t end = lines.find('\n'); end != std::string_view::npos; end = lines.find('\n', begin)) {
+        const std::string_view line = lines.substr(begin, end - begin);
+        if (line.find_first_not_of(" \t\r"sv) != std::string_view::npos) {
+            answers += HandleRequest(line);
+            answers += '\n';
+        }
+        begin = end + 1;
+    }
+    return answers;
+}
+
+// listens the unix domain socket
+// the calling thread polls the connections and passes received lines to the pool of threads,
+// a connection is not polled while its answers are prepared, so the answers keep the order of requests
+// and idle connections don't hold the threads
+bool FitServer::ServeUnixSocket(const std::string& path) {
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::copy(path.begin(), path.end(), address.sun_path);
+
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        return false;
+    }
+    unlink(path.c_str());
+    if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0
+            || listen(listener, SOMAXCONN) < 0) {
+        close(listener);
+        return false;
+    }
+    // workers wake the polling thread through the pipe when a connection is free again
+    int wake_pipe[2];
+    if (pipe(wake_pipe) < 0) {
+        close(listener);
+        return false;
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::queue<Task> tasks;
+    std::map<int, Connection> connections;
+    bool stop = false;
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads_count_);
+    for (size_t i = 0; i < threads_count_; ++i) {
+        workers.emplace_back([&] {
+            while (true) {
+                Task task;
+                {
+                    std::unique_lock lock(mutex);
+                    cv.wait(lock, [&] {
+                        return stop || !tasks.empty();
+                    });
+                    if (tasks.empty()) {
+                        return;
+                    }
+                    task = std::move(tasks.front());
+                    tasks.pop();
+                }
+                std::string answers = AnswerLines(task.lines);
+                if (task.too_long) {
+                    answers += io::ErrorToJson("request line is longer than "s + std::to_string(MAX_LINE_LENGTH)
+                                               + " bytes"s);
+                    answers += '\n';
+                }
+                const bool sent = SendAll(task.socket, answers);
+                {
+                    std::lock_guard lock(mutex);
+                    Connection& connection = connections.at(task.socket);
+                    connection.busy = false;
+                    connection.closed = connection.closed || !sent || task.too_long;
+                }
+                const char signal = 0;
+                [[maybe_unused]] const ssize_t res = write(wake_pipe[1], &signal, 1);
+            }
+        });
+    }
+
+    char chunk[1 << 16];
+    std::vector<pollfd> polled;
+    while (true) {
+        polled.assign({{wake_pipe[0], POLLIN, 0}, {listener, POLLIN, 0}});
+        {
+            std::lock_guard lock(mutex);
+            for (auto iter = connections.begin(); iter != connections.end();) {
+                if (iter->second.busy) {
+                    ++iter;
+                } else if (iter->second.closed) {
+                    close(iter->first);
+                    iter = connections.erase(iter);
+                } else {
+                    polled.push_back({iter->first, POLLIN, 0});
+                    ++iter;
+                }
+            }
+        }
+        if (poll(polled.data(), polled.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        if (polled[0].revents) {
+            read(wake_pipe[0], chunk, sizeof(chunk));
+        }
+        if (polled[1].revents) {
+            const int connection = accept(listener, nullptr, nullptr);
+            if (connection >= 0) {
+                std::lock_guard lock(mutex);
+                connections[connection];
+            } else if (errno != EINTR && errno != ECONNABORTED) {
+                break;
+            }
+        }
+
+        for (size_t i = 2; i < polled.size(); ++i) {
+            if (!polled[i].revents) {
+                continue;
+            }
+            const ssize_t size = read(polled[i].fd, chunk, sizeof(chunk));
+            if (size < 0 && errno == EINTR) {
+                continue;
+            }
+            std::lock_guard lock(mutex);
+            Connection& connection = connections.at(polled[i].fd);
+            if (size <= 0) {
+                connection.closed = true;
+                continue;
+            }
+            connection.buffer.append(chunk, static_cast<size_t>(size));
+            const size_t end = connection.buffer.rfind('\n');
+            const size_t tail = end == std::string::npos ? 0 : end + 1;
+            const bool too_long = connection.buffer.size() - tail > MAX_LINE_LENGTH;
+            if (tail == 0 && !too_long) {
+                continue;
+            }
+            // complete lines are still answered before the error of the too long one
+            Task task{polled[i].fd, connection.buffer.substr(0, tail), too_long};
+            if (too_long) {
+                connection.buffer.clear();
+                connection.buffer.shrink_to_fit();
+            } else {
+                connection.buffer.erase(0, tail);
+            }
+            connection.busy = true;
+            tasks.push(std::move(task));
+            cv.notify_one();
+        }
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        stop = true;
+    }
+    cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (const auto& [socket, connection] : connections) {
+        close(socket);
+    }
+    close(wake_pipe[0]);
+    close(wake_pipe[1]);
+    close(listener);
+    unlink(path.c_str());
+    return true;
+}
+
+#else
+
+std::string FitServer::AnswerLines(std::string_view lines) {
+    return {};
+}
+
+bool FitServer::ServeUnixSocket(const std::string& path) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "approximator.h"
+#include "data_reader.h"
+#include "graph_renderer.h"
+
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// long-running server which keeps fitted data sets in memory between requests
+// every request and answer is one line of JSON:
+// {"command": "fit", "name": "density", "degree": 2, "data": [[x, y], ...]}
+//     fits the data and stores it by name; without data refits stored data with the degree
+// {"command": "evaluate", "name": "density", "x": [x0, x1, ...]}
+//     returns values of the stored polynomial
+// {"command": "render", "name": "density"}
+//     returns svg graph of the stored fit
+// errors are answered with {"error": "message"}
+class FitServer {
+public:
+    // threads_count = 0 means the number of hardware threads
+    explicit FitServer(const renderer::RenderSettings& settings, size_t default_degree = 2,
+                       size_t threads_count = 0);
+
+    // handles one request line and returns the answer line
+    // can be called from many threads at once
+    std::string HandleRequest(std::string_view line);
+
+    // answers requests from in line by line until the end of the stream
+    void ServeStream(std::istream& in, std::ostream& out);
+
+    // longest request line of a socket connection, a longer line is answered with an error
+    // and the connection is closed, so one client can't exhaust the memory of the server
+    static constexpr size_t MAX_LINE_LENGTH = 16 << 20;
+
+    // listens the unix domain socket, requests of all connections are answered by the pool of threads
+    // returns false if the socket can't be opened
+    bool ServeUnixSocket(const std::string& path);
+
+private:
+    // stored data set, approximator caches the last polynomial
+    struct Fit {
+        std::mutex mutex;
+        Approximator app;
+    };
+
+    std::string HandleFit(io::FitRequest& request);
+    std::string HandleEvaluate(std::string_view name, const std::vector<double>& x);
+    std::string HandleRender(std::string_view name);
+
+    // returns nullptr if there is no fit with the name
+    std::shared_ptr<Fit> FindFit(std::string_view name) const;
+
+    // answers complete lines of requests received from a socket
+    std::string AnswerLines(std::string_view lines);
+
+    renderer::GraphRenderer renderer_;
+    size_t default_degree_;
+    size_t threads_count_;
+
+    mutable std::shared_mutex fits_mutex_;
+    std::unordered_map<std::string, std::shared_ptr<Fit>> fits_;
+};
@@ -0,0 +1,127 @@
+#include "gram_basis.h"
+#include "alloc_tracker.h"
+#include "profiler.h"
+
+template <typename T>
+bool IsUniformGrid(const std::vector<BasicData<T>>& data, T tolerance) {
+    if (data.size() < 2) {
+        return false;
+    }
+    const T first_x = data.front().x;
+    const T step = (data.back().x - first_x) / static_cast<T>(data.size() - 1);
+    if (step == 0) {
+        return false;
+    }
+    const T max_deviation = std::abs(step) * tolerance;
+    for (size_t i = 1; i + 1 < data.size(); ++i) {
+        if (std::abs(data[i].x - (first_x + static_cast<T>(i) * step)) > max_deviation) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the basis is built by the recurrence of orthogonal polynomials (Stieltjes procedure):
+// P_0 = 1, P_1 = u, P_k+1 = u * P_k - beta_k * P_k-1, beta_k = |P_k|^2 / |P_k-1|^2
+// alpha_k = sum(u * P_k^2) / |P_k|^2 is zero because the grid is symmetric
+template <typename T>
+GramBasis<T>::GramBasis(size_t points_count, size_t degree)
+        : points_count_{points_count},
+          degree_{degree},
+          weights_(points_count * (degree + 1)),
+          monomials_(degree + 1, std::vector<T>(degree + 1)) {
+    PROFILE_SCOPE("GramBasis::GramBasis");
+    const size_t width = degree_ + 1;
+
+    // u_i evenly spaced in [-1, 1]
+    std::vector<T> u(points_count_);
+    for (size_t i = 0; i < points_count_; ++i) {
+        u[i] = points_count_ > 1
+            ? static_cast<T>(2 * i) / static_cast<T>(points_count_ - 1) - 1
+            : T{0};
+    }
+
+    std::vector<T> prev(points_count_, T{0});
+    std::vector<T> current(points_count_, T{1});
+    std::vector<T> next(points_count_);
+    std::vector<T> norms(width);
+    monomials_[0][0] = 1;
+
+    for (size_t k = 0; k <= degree_; ++k) {
+        T norm = 0;
+        for (T value : current) {
+            norm += value * value;
+        }
+        norms[k] = norm;
+        for (size_t i = 0; i < points_count_; ++i) {
+            weights_[i * width + k] = current[i] / norm;
+        }
+        if (k == degree_) {
+            break;
+        }
+
+        const T beta = k > 0 ? norm / norms[k - 1] : T{0};
+        for (size_t i = 0; i < points_count_; ++i) {
+            next[i] = u[i] * current[i] - beta * prev[i];
+        }
+        // the same recurrence for the coefficients
+        for (size_t j = 0; j <= k + 1; ++j) {
+            const T shifted = j > 0 ? monomials_[k][j - 1] : T{0};
+            const T previous = k > 0 ? monomials_[k - 1][j] : T{0};
+            monomials_[k + 1][j] = shifted - beta * previous;
+        }
+        std::swap(prev, current);
+        std::swap(current, next);
+    }
+}
+
+template <typename T>
+BasicPolynomial<T> GramBasis<T>::Fit(const std::vector<BasicData<T>>& data) const {
+    PROFILE_SCOPE("GramBasis::Fit");
+    ALLOC_STAGE("fit");
+    PROFILE_COUNTER("points", data.size());
+    const size_t width = degree_ + 1;
+
+    // coefficients in the basis
+    std::vector<T> basis_coeffs(width, T{0});
+    for (size_t i = 0; i < points_count_; ++i) {
+        const T y = data[i].y;
+        const T* weights = &weights_[i * width];
+        for (size_t k = 0; k < width; ++k) {
+            basis_coeffs[k] += y * weights[k];
+        }
+    }
+
+    // coefficients in powers of u
+    std::vector<T> u_coeffs(width, T{0});
+    for (size_t k = 0; k < width; ++k) {
+        for (size_t j = 0; j <= k; ++j) {
+            u_coeffs[j] += basis_coeffs[k] * monomials_[k][j];
+        }
+    }
+
+    // u = (x - center) / half_range, (x - center)^j is expanded by the binomial formula
+    const T center = (data.front().x + data.back().x) / 2;
+    const T half_range = points_count_ > 1 ? (data.back().x - data.front().x) / 2 : T{1};
+    std::vector<T> coeffs(width, T{0});
+    T scale = 1;  // 1 / half_range^j
+    for (size_t j = 0; j < width; ++j) {
+        T binomial = 1;  // C(j, l)
+        T center_power = 1;  // (-center)^(j - l)
+        for (size_t l = j + 1; l-- > 0;) {
+            coeffs[l] += u_coeffs[j] * scale * binomial * center_power;
+            binomial = binomial * static_cast<T>(l) / static_cast<T>(j - l + 1);
+            center_power *= -center;
+        }
+        scale /= half_range;
+    }
+    return BasicPolynomial<T>(std::move(coeffs));
+}
+
+#define INSTANTIATE_GRAM_BASIS(T) \
+    template bool IsUniformGrid<T>(const std::vector<BasicData<T>>&, T); \
+    template class GramBasis<T>
+
+INSTANTIATE_GRAM_BASIS(float);
+INSTANTIATE_GRAM_BASIS(double);
+INSTANTIATE_GRAM_BASIS(long double);
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "approximator.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// returns true if x of the points go with the same step up to tolerance * step
+// there must be at least two points and the step must not be zero
+template <typename T>
+bool IsUniformGrid(const std::vector<BasicData<T>>& data,
+                   T tolerance = std::sqrt(std::numeric_limits<T>::epsilon()));
+
+// discrete orthogonal (Gram) polynomials on m uniformly spaced points up to the degree
+// the grid is mapped to [-1, 1], so the basis depends only on m and may be reused for any grid of m points
+// the fit is the projection on the basis: c_k = sum(y_i * P_k(u_i)) / sum(P_k(u_i)^2),
+// it takes one O(m * n) pass through the data without a system of equations
+// templates are explicitly instantiated for float, double and long double in gram_basis.cpp
+template <typename T>
+class GramBasis {
+public:
+    // degree must be less than points_count
+    GramBasis(size_t points_count, size_t degree);
+
+    size_t GetPointsCount() const {
+        return points_count_;
+    }
+    size_t GetDegree() const {
+        return degree_;
+    }
+
+    // fits the data on the uniform grid, the data must have GetPointsCount() points sorted by x
+    BasicPolynomial<T> Fit(const std::vector<BasicData<T>>& data) const;
+
+private:
+    size_t points_count_;
+    size_t degree_;
+    // weights_[i * (degree_ + 1) + k] = P_k(u_i) / sum(P_k(u_j)^2), rows follow the points to stream the data
+    std::vector<T> weights_;
+    // coefficients of P_k in powers of u
+    BasicMatrix<T> monomials_;
+};
@@ -1,9 +1,89 @@
 #include "graph_renderer.h"
+#include "alloc_tracker.h"
+#include "profiler.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
 
 namespace renderer {
+
+namespace {
+// id of the source point symbol in <defs>
+const std::string POINT_SYMBOL_ID = "p";
+
+// round screen coordinate to tenths of a pixel
+long long ToTenths(double value) {
+    return std::llround(value * 10);
+}
+
+// append number of tenths as a decimal: 12 -> "1.2", -30 -> "-3"
+void AppendTenths(std::string& str, long long value) {
+    if (value < 0) {
+        str += '-';
+        value = -value;
+    }
+    char buffer[24];
+    auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value / 10);
+    str.append(buffer, end);
+    if (value % 10) {
+        str += '.';
+        str += static_cast<char>('0' + value % 10);
+    }
+}
+
+void AppendPair(std::string& str, long long x, long long y) {
+    AppendTenths(str, x);
+    str += ',';
+    AppendTenths(str, y);
+}
+
+// opacity of one point in DENSITY mode if the color of points is opaque
+const double DENSITY_POINT_OPACITY = 0.3;
+
+// opacity of count circles of the opacity drawn over each other
+double GetStackedOpacity(double opacity, size_t count) {
+    return 1 - std::pow(1 - opacity, static_cast<double>(count));
+}
+
+// the band is drawn if it is enabled and has a half-width for every result point
+bool IsBandDrawn(const RenderSettings& settings, const std::vector<Data>& result_points,
+                 const std::vector<double>& confidence_band) {
+    return settings.draw_confidence_band && !confidence_band.empty()
+           && confidence_band.size() == result_points.size();
+}
+
+// returns lower and upper points of the band, the band must fit into the picture
+std::vector<Data> GetBandEdges(const std::vector<Data>& result_points, const std::vector<double>& confidence_band) {
+    std::vector<Data> band_edges;
+    band_edges.reserve(2 * result_points.size());
+    for (size_t i = 0; i < result_points.size(); ++i) {
+        band_edges.push_back({result_points[i].x, result_points[i].y - confidence_band[i]});
+        band_edges.push_back({result_points[i].x, result_points[i].y + confidence_band[i]});
+    }
+    return band_edges;
+}
+}  // namespace
+
 // add source data to the svg doc
-void GraphRenderer::AddSourcePoints(svg::Document& doc, const ScreenProjector& proj,
+void GraphRenderer::AddSourcePoints(svg::ObjectContainer& doc, const ScreenProjector& proj,
         const std::vector<Data>& points) const {
+    switch (settings_.points_encoding) {
+        case PointsEncoding::SYMBOL:
+        AddSourceSymbols(doc, proj, points);
+        return;
+        case PointsEncoding::PATH:
+        AddSourcePath(doc, proj, points);
+        return;
+        case PointsEncoding::DENSITY:
+        AddSourceDensity(doc, proj, points);
+        return;
+        case PointsEncoding::CIRCLES:
+        break;
+    }
+
     for (auto point : points) {
         doc.Add(svg::Circle()
             .SetCenter(proj(point))
@@ -12,8 +92,145 @@ void GraphRenderer::AddSourcePoints(svg::Document& doc, const ScreenProjector& p
     }
 }
 
+// add circle in <defs> and <use> element for each source point
+void GraphRenderer::AddSourceSymbols(svg::ObjectContainer& doc, const ScreenProjector& proj,
+        const std::vector<Data>& points) const {
+    if (points.empty()) {
+        return;
+    }
+    svg::Defs defs;
+    defs.Add(POINT_SYMBOL_ID, svg::Circle()
+        .SetRadius(settings_.radius)
+        .SetFillColor(settings_.circle_color));
+    doc.Add(std::move(defs));
+
+    for (auto point : points) {
+        doc.Add(svg::Use()
+            .SetHref(POINT_SYMBOL_ID)
+            .SetPosition(proj(point)));
+    }
+}
+
+// add all source points as a single path
+// each point is a zero-length segment drawn with round cap of diameter 2*radius,
+// next point starts with relative move
+void GraphRenderer::AddSourcePath(svg::ObjectContainer& doc, const ScreenProjector& proj,
+        const std::vector<Data>& points) const {
+    if (points.empty()) {
+        return;
+    }
+    std::string data;
+    data.reserve(points.size() * 16);
+
+    long long prev_x = 0;
+    long long prev_y = 0;
+    bool first = true;
+    for (auto point : points) {
+        const svg::Point screen = proj(point);
+        const long long x = ToTenths(screen.x);
+        const long long y = ToTenths(screen.y);
+        if (first) {
+            data += 'M';
+            AppendPair(data, x, y);
+            first = false;
+        } else {
+            data += 'm';
+            AppendPair(data, x - prev_x, y - prev_y);
+        }
+        data += "h0";
+        prev_x = x;
+        prev_y = y;
+    }
+
+    doc.Add(svg::Path()
+        .SetData(std::move(data))
+        .SetFillColor(svg::NoneColor)
+        .SetStrokeColor(settings_.circle_color)
+        .SetStrokeWidth(2 * settings_.radius)
+        .SetStrokeLineCap(svg::StrokeLineCap::ROUND));
+}
+
+// add one circle per pixel with source points
+void GraphRenderer::AddSourceDensity(svg::ObjectContainer& doc, const ScreenProjector& proj,
+        const std::vector<Data>& points) const {
+    struct Cell {
+        long long x;
+        long long y;
+        size_t count;
+    };
+    // cells in order of the first point in them
+    std::vector<Cell> cells;
+    std::unordered_map<uint64_t, size_t> cell_indexes;
+
+    for (auto point : points) {
+        const svg::Point screen = proj(point);
+        const long long x = static_cast<long long>(std::floor(screen.x));
+        const long long y = static_cast<long long>(std::floor(screen.y));
+        const uint64_t key = (static_cast<uint64_t>(x) << 32) ^ static_cast<uint32_t>(y);
+
+        const auto [iter, inserted] = cell_indexes.emplace(key, cells.size());
+        if (inserted) {
+            cells.push_back({x, y, 1});
+        } else {
+            ++cells[iter->second].count;
+        }
+    }
+
+    // the opacity of rgba is stacked in the color, other colors (names, rgb) are opaque:
+    // their count is shown by fill-opacity in steps of DENSITY_POINT_OPACITY
+    const auto* rgba = std::get_if<svg::Rgba>(&settings_.circle_color);
+    for (const Cell& cell : cells) {
+        svg::Circle circle;
+        circle.SetCenter({cell.x + 0.5, cell.y + 0.5})
+            .SetRadius(settings_.radius);
+        if (rgba) {
+            svg::Rgba color = *rgba;
+            color.opacity = GetStackedOpacity(rgba->opacity, cell.count);
+            circle.SetFillColor(color);
+        } else {
+            circle.SetFillColor(settings_.circle_color)
+                .SetFillOpacity(GetStackedOpacity(DENSITY_POINT_OPACITY, cell.count));
+        }
+        doc.Add(std::move(circle));
+    }
+}
+
+// returns screen points of the polynomial graph after simplification
+std::vector<svg::Point> GraphRenderer::GetGraphPoints(const ScreenProjector& proj,
+        const std::vector<Data>& points) const {
+    std::vector<svg::Point> screen_points;
+    screen_points.reserve(points.size());
+    for (auto point : points) {
+        screen_points.push_back(proj(point));
+    }
+    return SimplifyPolyline(std::move(screen_points),
+                            settings_.simplification, settings_.simplify_tolerance);
+}
+
+// adds filled polygon between the lower and the upper edges of the band
+void GraphRenderer::AddConfidenceBand(svg::ObjectContainer& doc, const ScreenProjector& proj,
+        const std::vector<Data>& result_points, const std::vector<double>& confidence_band) const {
+    // the upper edge from left to right and the lower one back, the fill closes the polygon
+    std::vector<Data> edges;
+    edges.reserve(2 * result_points.size());
+    for (size_t i = 0; i < result_points.size(); ++i) {
+        edges.push_back({result_points[i].x, result_points[i].y + confidence_band[i]});
+    }
+    for (size_t i = result_points.size(); i-- > 0;) {
+        edges.push_back({result_points[i].x, result_points[i].y - confidence_band[i]});
+    }
+
+    svg::Polyline band;
+    band.SetFillColor(settings_.band_color)
+        .SetStrokeColor(svg::NoneColor);
+    for (auto point : GetGraphPoints(proj, edges)) {
+        band.AddPoint(point);
+    }
+    doc.Add(band);
+}
+
 // adds a polyline to the doc from the points of the polynomial
-void GraphRenderer::AddGraphPolyline(svg::Document& doc, const ScreenProjector& proj,
+void GraphRenderer::AddGraphPolyline(svg::ObjectContainer& doc, const ScreenProjector& proj,
         const std::vector<Data>& points) const {
     svg::Polyline graph;
 
@@ -23,81 +240,124 @@ void GraphRenderer::AddGraphPolyline(svg::Document& doc, const ScreenProjector&
          .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND)
          .SetFillColor(svg::NoneColor);
 
-    for (auto point : points) {
-        graph.AddPoint(proj(point));
+    for (auto point : GetGraphPoints(proj, points)) {
+        graph.AddPoint(point);
     }
     doc.Add(graph);
 }
 
+// returns ends of the coordinates axis and of the borders
+std::vector<std::pair<svg::Point, svg::Point>> GraphRenderer::GetAxisLines() const {
+    const double left = settings_.padding;
+    const double right = settings_.width - settings_.padding;
+    const double top = settings_.padding;
+    const double bottom = settings_.height - settings_.padding;
+
+    return {
+        {{left, settings_.height / 2}, {right, settings_.height / 2}},  // x axis
+        {{settings_.width / 2, top}, {settings_.width / 2, bottom}},  // y axis
+        {{left, top}, {left, bottom}},  // left border
+        {{right, top}, {right, bottom}},  // right border
+        {{left, top}, {right, top}},  // top border
+        {{left, bottom}, {right, bottom}},  // bottom border
+    };
+}
+
 // add lines of coordinates axis
-void GraphRenderer::AddAxis(svg::Document& doc,
-                            const ScreenProjector& proj,
-                            const std::vector<Data>& points) const {
+void GraphRenderer::AddAxis(svg::ObjectContainer& doc, const ScreenProjector& proj,
+        const std::vector<Data>& points) const {
     using namespace std::literals;
-    svg::Point left(settings_.padding, settings_.height / 2);
-    svg::Point right(settings_.width - settings_.padding, settings_.height / 2);
-
-    doc.Add(svg::Line()
-                       .SetPoint1(left)
-                       .SetPoint2(right)
-                       .SetStrokeColor("Black"s)
-    );
-    svg::Point up(settings_.width / 2, settings_.padding);
-    svg::Point down(settings_.width / 2, settings_.height - settings_.padding);
-
-    doc.Add(svg::Line()
-                       .SetPoint1(up)
-                       .SetPoint2(down)
-                       .SetStrokeColor("Black"s)
-    );
-
-    // left border
-    doc.Add(svg::Line()
-                       .SetPoint1({settings_.padding,
-                                   settings_.padding})
-                       .SetPoint2({settings_.padding,
-                                   settings_.height - settings_.padding})
-                       .SetStrokeColor("Black"s)
-    );
-    // right border
-    doc.Add(svg::Line()
-                       .SetPoint1({settings_.width - settings_.padding,
-                                   settings_.padding})
-                       .SetPoint2({settings_.width - settings_.padding,
-                                   settings_.height - settings_.padding})
-                       .SetStrokeColor("Black"s)
-    );
-    // top border
-    doc.Add(svg::Line()
-                       .SetPoint1({settings_.padding,
-                                   settings_.padding})
-                       .SetPoint2({settings_.width - settings_.padding,
-                                   settings_.padding})
-                       .SetStrokeColor("Black"s)
-    );
-    // bottom border
-    doc.Add(svg::Line()
-                       .SetPoint1({settings_.padding,
-                                   settings_.height - settings_.padding})
-                       .SetPoint2({settings_.width - settings_.padding,
-                                   settings_.height - settings_.padding})
-                       .SetStrokeColor("Black"s)
-    );
-
+    for (const auto& [from, to] : GetAxisLines()) {
+        doc.Add(svg::Line()
+                           .SetPoint1(from)
+                           .SetPoint2(to)
+                           .SetStrokeColor("Black"s)
+        );
+    }
 }
 
 svg::Document GraphRenderer::Render(const std::vector<Data>& source_points,
-                                    const std::vector<Data>& result_points) const {
-    ScreenProjector proj(result_points, settings_);
-
+                                    const std::vector<Data>& result_points,
+                                    const std::vector<double>& confidence_band) const {
     svg::Document doc;
+    Render(doc, source_points, result_points, confidence_band);
+    return doc;
+}
+
+// writes svg elements to the out as they are produced, without building a svg::Document
+void GraphRenderer::Render(const std::vector<Data>& source_points,
+                           const std::vector<Data>& result_points,
+                           std::ostream& out,
+                           const std::vector<double>& confidence_band) const {
+    svg::StreamDocument doc(out);
+    Render(doc, source_points, result_points, confidence_band);
+    doc.Finish();
+}
+
+// add all graph elements to the container
+void GraphRenderer::Render(svg::ObjectContainer& container,
+                           const std::vector<Data>& source_points,
+                           const std::vector<Data>& result_points,
+                           const std::vector<double>& confidence_band) const {
+    PROFILE_SCOPE("GraphRenderer::Render");
+    ALLOC_STAGE("render/graph");
+    PROFILE_COUNTER("rendered points", source_points.size() + result_points.size());
+    const bool draw_band = IsBandDrawn(settings_, result_points, confidence_band);
+    ScreenProjector proj(draw_band ? GetBandEdges(result_points, confidence_band) : result_points, settings_);
+
+    if (settings_.draw_axis) {
+        AddAxis(container, proj, result_points);
+    }
+    if (draw_band) {
+        AddConfidenceBand(container, proj, result_points, confidence_band);
+    }
+    AddGraphPolyline(container, proj, result_points);
+    AddSourcePoints(container, proj, source_points);
+}
+// draws graph straight into the pixel buffer, without svg
+raster::Image GraphRenderer::RenderImage(const std::vector<Data>& source_points,
+                                         const std::vector<Data>& result_points,
+                                         const std::vector<double>& confidence_band) const {
+    PROFILE_SCOPE("GraphRenderer::RenderImage");
+    ALLOC_STAGE("render/image");
+    using namespace std::literals;
+    const bool draw_band = IsBandDrawn(settings_, result_points, confidence_band);
+    ScreenProjector proj(draw_band ? GetBandEdges(result_points, confidence_band) : result_points, settings_);
+
+    raster::Image image(static_cast<size_t>(std::ceil(settings_.width)),
+                        static_cast<size_t>(std::ceil(settings_.height)));
 
     if (settings_.draw_axis) {
-        AddAxis(doc, proj, result_points);
+        const raster::Paint black = *raster::ToPaint("Black"s);
+        for (const auto& [from, to] : GetAxisLines()) {
+            image.DrawLine(from, to, black, 1);
+        }
     }
-    AddGraphPolyline(doc, proj, result_points);
-    AddSourcePoints(doc, proj, source_points);
 
-    return doc;
+    if (const auto band_paint = raster::ToPaint(settings_.band_color); draw_band && band_paint) {
+        std::vector<svg::Point> upper;
+        std::vector<svg::Point> lower;
+        upper.reserve(result_points.size());
+        lower.reserve(result_points.size());
+        for (size_t i = 0; i < result_points.size(); ++i) {
+            upper.push_back(proj({result_points[i].x, result_points[i].y + confidence_band[i]}));
+            lower.push_back(proj({result_points[i].x, result_points[i].y - confidence_band[i]}));
+        }
+        image.FillBand(upper, lower, *band_paint);
+    }
+
+    if (const auto line_paint = raster::ToPaint(settings_.line_color)) {
+        const auto graph_points = GetGraphPoints(proj, result_points);
+        for (size_t i = 1; i < graph_points.size(); ++i) {
+            image.DrawLine(graph_points[i - 1], graph_points[i], *line_paint, settings_.line_width);
+        }
+    }
+
+    if (const auto circle_paint = raster::ToPaint(settings_.circle_color)) {
+        for (auto point : source_points) {
+            image.FillCircle(proj(point), settings_.radius, *circle_paint);
+        }
+    }
+    return image;
 }
 }  // namespace renderer
\ No newline at end of file
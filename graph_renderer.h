@@ -1,13 +1,24 @@
 #pragma once
 
 #include "approximator.h"
+#include "polyline_simplifier.h"
+#include "raster.h"
 #include "svg.h"
 
 #include <algorithm>
+#include <utility>
 #include <vector>
 
 namespace renderer {
 
+// the way source points are written to the svg
+enum class PointsEncoding {
+    CIRCLES,  // <circle> element per point
+    SYMBOL,  // one circle in <defs> and <use> element per point
+    PATH,  // one <path> with a round dot per point, coordinates rounded to 0.1
+    DENSITY,  // one <circle> per occupied pixel, number of points is kept as opacity (fill-opacity for opaque colors)
+};
+
 struct RenderSettings {
     // picture size
     double width{};
@@ -22,6 +33,15 @@ struct RenderSettings {
     svg::Color circle_color{};  // color of circle
 
     bool draw_axis = true;  // draw coordinates axis or not
+
+    PointsEncoding points_encoding = PointsEncoding::CIRCLES;  // encoding of source points
+
+    Simplification simplification = Simplification::NONE;  // simplification of graph polyline
+    double simplify_tolerance = 0.5;  // simplification tolerance in pixels
+
+    bool draw_confidence_band = false;  // draw confidence band around the graph when it is given
+    double confidence_z = 1.96;  // half-width of the band in standard deviations of the values
+    svg::Color band_color{std::string{"LightGray"}};  // fill color of the band
 };
 
 namespace {
@@ -100,20 +120,69 @@ public:
     explicit GraphRenderer(const RenderSettings& settings) : settings_{settings} {
     }
 
+    const RenderSettings& GetSettings() const {
+        return settings_;
+    }
+
+    // confidence_band has half-widths of the band at result points, see GetConfidenceBand
+    // the band is drawn if it is not empty and draw_confidence_band is set
     svg::Document Render(const std::vector<Data>& source_points,
-                         const std::vector<Data>& result_points) const;
+                         const std::vector<Data>& result_points,
+                         const std::vector<double>& confidence_band = {}) const;
+
+    // writes svg elements to the out as they are produced, without building a svg::Document
+    void Render(const std::vector<Data>& source_points,
+                const std::vector<Data>& result_points,
+                std::ostream& out,
+                const std::vector<double>& confidence_band = {}) const;
+
+    // add all graph elements to the container
+    void Render(svg::ObjectContainer& container,
+                const std::vector<Data>& source_points,
+                const std::vector<Data>& result_points,
+                const std::vector<double>& confidence_band = {}) const;
+
+    // draws graph straight into the pixel buffer, without svg
+    // the confidence band is drawn as in svg
+    raster::Image RenderImage(const std::vector<Data>& source_points,
+                              const std::vector<Data>& result_points,
+                              const std::vector<double>& confidence_band = {}) const;
 
 private:
     // add source data to the svg doc
-    void AddSourcePoints(svg::Document& doc, const ScreenProjector& proj,
+    void AddSourcePoints(svg::ObjectContainer& doc, const ScreenProjector& proj,
+        const std::vector<Data>& source_points) const;
+
+    // add circle in <defs> and <use> element for each source point
+    void AddSourceSymbols(svg::ObjectContainer& doc, const ScreenProjector& proj,
         const std::vector<Data>& source_points) const;
 
+    // add all source points as a single path
+    void AddSourcePath(svg::ObjectContainer& doc, const ScreenProjector& proj,
+        const std::vector<Data>& source_points) const;
+
+    // add one circle per pixel with source points
+    void AddSourceDensity(svg::ObjectContainer& doc, const ScreenProjector& proj,
+        const std::vector<Data>& source_points) const;
+
+    // returns screen points of the polynomial graph after simplification
+    std::vector<svg::Point> GetGraphPoints(const ScreenProjector& proj,
+        const std::vector<Data>& result_points) const;
+
+    // adds filled polygon between the lower and the upper edges of the band
+    void AddConfidenceBand(svg::ObjectContainer& doc, const ScreenProjector& proj,
+        const std::vector<Data>& result_points, const std::vector<double>& confidence_band) const;
+
     // adds a polyline to the doc from the points of the polynomial
-    void AddGraphPolyline(svg::Document& doc, const ScreenProjector& proj,
+    void AddGraphPolyline(svg::ObjectContainer& doc, const ScreenProjector& proj,
         const std::vector<Data>& result_points) const;
 
+    // returns ends of the coordinates axis and of the borders
+    std::vector<std::pair<svg::Point, svg::Point>> GetAxisLines() const;
+
     // add lines of coordinates axis
-    void AddAxis(svg::Document& doc, const ScreenProjector& proj, const std::vector<Data>& points) const;
+    void AddAxis(svg::ObjectContainer& doc, const ScreenProjector& proj,
+        const std::vector<Data>& points) const;
 
     RenderSettings settings_;
 };
@@ -1,11 +1,30 @@
+#include <charconv>
 #include <cmath>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <numeric>
+#include <optional>
 #include <random>
+#include <string_view>
+#include <thread>
 
+#include "alloc_tracker.h"
 #include "approximator_manager.h"
+#include "batch_runner.h"
+#include "data_reader.h"
+#include "data_reducer.h"
+#include "fit_report.h"
+#include "fit_server.h"
 #include "graph_renderer.h"
+#include "minimax_fitter.h"
+#include "profiler.h"
+#include "property_library.h"
+#include "rational_function.h"
+#include "request_fitter.h"
+#include "result_writer.h"
+#include "robust_fitter.h"
+#include "tiled_renderer.h"
 
 using namespace std::literals;
 
@@ -99,6 +118,18 @@ void TestGetSolve() {
     std::cout << "SSE = "s << app.GetSumSquaredErrors() << std::endl;
 }
 
+renderer::RenderSettings GetDefaultRenderSettings() {
+    return {
+        .width = 500,
+        .height = 500,
+        .padding = 10,
+        .line_width = 1,
+        .radius = 3,
+        .line_color = svg::Color("Black"s),
+        .circle_color = svg::Color("Red"s)
+    };
+}
+
 void TestRendering() {
     size_t max_power = 2;
 
@@ -115,16 +146,7 @@ void TestRendering() {
     app.SetData(data);
     auto res = app.GetPolynom(max_power);
 
-    renderer::RenderSettings settings{
-        .width = 500,
-        .height = 500,
-        .padding = 10,
-        .line_width = 1,
-        .radius = 3,
-        .line_color = svg::Color("Black"s),
-        .circle_color = svg::Color("Red"s)
-    };
-    renderer::GraphRenderer renderer(settings);
+    renderer::GraphRenderer renderer(GetDefaultRenderSettings());
     ApproximatorManager app_manager(app, renderer);
 
     std::ofstream out("graph_1.svg");
@@ -143,8 +165,317 @@ void TestRendering() {
     std::cout << "SSE = "s << app.GetSumSquaredErrors() << std::endl;
 }
 
-int main() {
-    //TestGetSolve();
-    TestRendering();
+// writes fitted functions of the results to the binary library, unnamed results are named by their indexes
+// returns false if the file can't be written
+bool WriteLibrary(const std::string& path, const std::vector<io::FitResult>& results) {
+    library::LibraryWriter writer;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const io::FitResult& result = results[i];
+        std::string name = result.name.empty() ? std::to_string(i) : result.name;
+        bool added = true;
+        if (result.rational) {
+            added = writer.Add(std::move(name), *result.rational, result.min_x, result.max_x);
+        } else if (result.polynom) {
+            added = writer.Add(std::move(name), *result.polynom, result.min_x, result.max_x);
+        }
+        if (!added) {
+            std::cerr << "Duplicate name "s << result.name << " is not written to the library"s << std::endl;
+        }
+    }
+    // readers may have the old file mapped: it is replaced by the new one, not truncated under them
+    const std::string temp_path = path + ".tmp"s;
+    std::error_code ec;
+    {
+        std::ofstream out(temp_path, std::ios::binary);
+        if (!writer.Write(out) || !out.flush()) {
+            std::filesystem::remove(temp_path, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+// reads data sets from in (JSON or CSV), approximates them by the settings and writes JSON results to out
+// fitted functions are also written to the binary library if the path is not empty
+// and polynomials with their data are drawn as panels of one svg if the path of tiles is not empty
+int ProcessRequests(std::istream& in, std::ostream& out, size_t default_degree, const FitSettings& settings,
+                    const std::string& library_path, const renderer::RenderSettings& render_settings,
+                    const std::string& tiles_path) {
+    std::vector<io::FitRequest> requests;
+    try {
+        requests = io::ReadRequests(io::ReadAll(in), default_degree);
+    } catch (const io::ParsingError& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::vector<io::FitResult> results;
+    results.reserve(requests.size());
+    std::vector<renderer::Panel> panels;
+    for (io::FitRequest& request : requests) {
+        Approximator app;
+        const io::FitResult& result = results.emplace_back(ProcessRequest(request, settings, app));
+        if (!tiles_path.empty() && result.polynom) {
+            panels.push_back({app.GetData(), *result.polynom});
+        }
+    }
+    io::WriteJson(out, results);
+    if (!library_path.empty() && !WriteLibrary(library_path, results)) {
+        std::cerr << "Can't write the library "s << library_path << std::endl;
+        return 1;
+    }
+    if (!tiles_path.empty()) {
+        // the grid is close to square
+        const auto columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(panels.size()))));
+        std::ofstream tiles(tiles_path);
+        try {
+            renderer::TiledRenderer(render_settings, columns).Render(panels, tiles);
+        } catch (const std::exception& e) {
+            std::cerr << "Can't draw the tiles: "s << e.what() << std::endl;
+            return 1;
+        }
+        if (!tiles) {
+            std::cerr << "Can't write the tiles "s << tiles_path << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void PrintUsage(std::ostream& out) {
+    out << "Usage: approximator [--degree N] [--robust METHOD] [--rational K | --max-error E [--relative]] [--test]\n"s
+        << "                    [--report N] [--reduce MODE] [--solve METHOD] [--library FILE] [--tiles FILE]\n"s
+        << "                    <input >output\n"s
+        << "       approximator [--degree N] --serve | --socket PATH\n"s
+        << "       approximator [--degree N] [--robust METHOD] [--rational K | --max-error E [--relative]] [--band]\n"s
+        << "                    [--report N] [--reduce MODE] [--solve METHOD] [--library FILE] [--svg-dir DIR]\n"s
+        << "                    [--image-format FORMAT] --batch FILE...\n"s
+        << "  input is JSON ({\"name\": ..., \"degree\": N, \"data\": [[x, y], ...]} or an array of them)\n"s
+        << "  or CSV with x and y pairs, output is JSON with polynomial coefficients\n"s
+        << "  --serve answers fit, evaluate and render requests line by line on stdin and stdout\n"s
+        << "  --socket PATH answers the same requests on the unix domain socket,\n"s
+        << "    the server fits plain least squares polynomials\n"s
+        << "  --batch fits all files in a pipeline and writes svg graphs to the --svg-dir\n"s
+        << "  --image-format ppm|bmp|png draws graphs of the batch straight to images instead of svg\n"s
+        << "  --band draws 95% confidence band of the polynomial on graphs\n"s
+        << "  --robust huber|tukey|ransac removes outliers found by the robust fit before the approximation\n"s
+        << "  --rational K fits rational functions with the numerator of the degree and the denominator of degree K\n"s
+        << "  --max-error E fits minimax polynomials of the lowest degree up to --degree with max |p(x) - y| <= E,\n"s
+        << "    --relative bounds max |p(x) - y| / |y| instead\n"s
+        << "  --report N adds R^2, RMSE, max residual and the histogram of N bins of residuals of least squares fits\n"s
+        << "  --reduce duplicates|N merges points of equal x (or in N bins of x) into weighted points\n"s
+        << "    before least squares fits, duplicates don't change the fit\n"s
+        << "  --solve refined|gauss solves least squares systems by LU with iterative refinement (the default)\n"s
+        << "    or by Gauss elimination without pivoting\n"s
+        << "  --library FILE also writes fitted functions to the binary library with O(1) lookup by name,\n"s
+        << "    see property_library.h\n"s
+        << "  --tiles FILE draws polynomials with their data as panels of one svg\n"s
+        << "  --profile FILE writes Chrome trace to the FILE and summary to stderr\n"s
+        << "    (the build must be configured with -DAPPROXIMATOR_PROFILING=ON)\n"s;
+}
+
+// writes profiler results when the work is done
+void WriteProfile(const std::string& trace_path) {
+    if (trace_path.empty()) {
+        return;
+    }
+    if (alloc::IsEnabled()) {
+        alloc::WriteSummary(std::cerr);
+    }
+    if (!profiler::IsEnabled()) {
+        std::cerr << "Profiling is disabled in this build"s << std::endl;
+        return;
+    }
+    profiler::WriteSummary(std::cerr);
+    std::ofstream trace(trace_path);
+    profiler::WriteChromeTrace(trace);
+}
+
+// parses the command line and runs the selected mode
+int Run(int argc, char* argv[], std::string& trace_path) {
+    size_t default_degree = 2;
+    bool serve = false;
+    std::string socket_path;
+    std::string svg_dir;
+    std::optional<raster::ImageFormat> image_format;
+    std::vector<std::string> batch_files;
+    renderer::RenderSettings render_settings = GetDefaultRenderSettings();
+    FitSettings fit_settings;
+    bool relative_error = false;
+    std::string library_path;
+    std::string tiles_path;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--degree"sv && i + 1 < argc) {
+            const std::string_view value = argv[++i];
+            const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), default_degree);
+            if (ec != std::errc{} || ptr != value.data() + value.size() || default_degree > io::MAX_DEGREE) {
+                PrintUsage(std::cerr);
+                return 1;
+            }
+        } else if (arg == "--serve"sv) {
+            serve = true;
+        } else if (arg == "--socket"sv && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (arg == "--profile"sv && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "--robust"sv && i + 1 < argc) {
+            const std::string_view method = argv[++i];
+            auto& robust = fit_settings.robust.emplace();
+            if (method == "huber"sv) {
+                robust.method = RobustMethod::HUBER;
+            } else if (method == "tukey"sv) {
+                robust.method = RobustMethod::TUKEY;
+            } else if (method == "ransac"sv) {
+                robust.method = RobustMethod::RANSAC;
+            } else {
+                PrintUsage(std::cerr);
+                return 1;
+            }
+        } else if (arg == "--rational"sv && i + 1 < argc) {
+            const std::string_view value = argv[++i];
+            const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(),
+                                                   fit_settings.rational_degree);
+            if (ec != std::errc{} || ptr != value.data() + value.size()) {
+                PrintUsage(std::cerr);
+                return 1;
+            }
+        } else if (arg == "--max-error"sv && i + 1 < argc) {
+            const std::string_view value = argv[++i];
+            auto& minimax = fit_settings.minimax.emplace();
+            const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), minimax.max_error);
+            if (ec != std::errc{} || ptr != value.data() + value.size() || !(minimax.max_error >= 0)) {
+                PrintUsage(std::cerr);
+                return 1;
+            }
+        } else if (arg == "--report"sv && i + 1 < argc) {
+            const std::string_view value = argv[++i];
+            const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(),
+                                                   fit_settings.report_bins);
+            if (ec != std::errc{} || ptr != value.data() + value.size() || fit_settings.report_bins == 0) {
+                PrintUsage(std::cerr);
+                return 1;
+            }
+        } else if (arg == "--reduce"sv && i + 1 < argc) {
+            const std::string_view value = argv[++i];
+            auto& reduction = fit_settings.reduction.emplace();
+            if (value != "duplicates"sv) {
+                reduction.mode = ReductionMode::BINS;
+                const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(),
+                                                       reduction.bins_count);
+                if (ec != std::errc{} || ptr != value.data() + value.size() || reduction.bins_count == 0) {
+                    PrintUsage(std::cerr);
+                    return 1;
+                }
+            }
+        } else if (arg == "--solve"sv && i + 1 < argc) {
+            const std::string_view method = argv[++i];
+            if (method == "refined"sv) {
+                fit_settings.solve_mode = SolveMode::REFINED;
+            } else if (method == "gauss"sv) {
+                fit_settings.solve_mode = SolveMode::GAUSS;
+            } else {
+                PrintUsage(std::cerr);
+                return 1;
+            }
+        } else if (arg == "--library"sv && i + 1 < argc) {
+            library_path = argv[++i];
+        } else if (arg == "--tiles"sv && i + 1 < argc) {
+            tiles_path = argv[++i];
+        } else if (arg == "--relative"sv) {
+            relative_error = true;
+        } else if (arg == "--band"sv) {
+            render_settings.draw_confidence_band = true;
+        } else if (arg == "--svg-dir"sv && i + 1 < argc) {
+            svg_dir = argv[++i];
+        } else if (arg == "--image-format"sv && i + 1 < argc) {
+            const std::string_view format = argv[++i];
+            if (format == "ppm"sv) {
+                image_format = raster::ImageFormat::PPM;
+            } else if (format == "bmp"sv) {
+                image_format = raster::ImageFormat::BMP;
+            } else if (format == "png"sv) {
+                image_format = raster::ImageFormat::PNG;
+            } else {
+                PrintUsage(std::cerr);
+                return 1;
+            }
+        } else if (arg == "--batch"sv && i + 1 < argc) {
+            batch_files.assign(argv + i + 1, argv + argc);
+            break;
+        } else if (arg == "--test"sv) {
+            //TestGetSolve();
+            TestRendering();
+            return 0;
+        } else {
+            PrintUsage(std::cerr);
+            return 1;
+        }
+    }
+
+    if ((relative_error && !fit_settings.minimax) || (fit_settings.minimax && fit_settings.rational_degree > 0)) {
+        PrintUsage(std::cerr);
+        return 1;
+    }
+    if (fit_settings.minimax && relative_error) {
+        fit_settings.minimax->error_type = ErrorType::RELATIVE;
+    }
+    // the server keeps plain least squares fits to evaluate and render them later
+    const bool fit_options = fit_settings.robust || fit_settings.rational_degree > 0 || fit_settings.minimax
+        || fit_settings.report_bins > 0 || fit_settings.reduction || fit_settings.solve_mode != SolveMode::REFINED
+        || !library_path.empty() || !tiles_path.empty();
+    // the batch draws graphs of the data sets to separate files of the --svg-dir, svg or images
+    if (((serve || !socket_path.empty()) && fit_options) || (!batch_files.empty() && !tiles_path.empty())
+            || (image_format && batch_files.empty())) {
+        PrintUsage(std::cerr);
+        return 1;
+    }
+
+    if (!batch_files.empty()) {
+        const size_t threads_count = std::max(1u, std::thread::hardware_concurrency());
+        BatchSettings settings{
+            .read_threads = 1,
+            .fit_threads = threads_count,
+            .render_threads = threads_count,
+            .output_dir = svg_dir,
+            .image_format = image_format,
+            .fit = fit_settings
+        };
+        const auto results = BatchRunner(render_settings, settings, default_degree).Run(batch_files);
+        io::WriteJson(std::cout, results);
+        if (!library_path.empty() && !WriteLibrary(library_path, results)) {
+            std::cerr << "Can't write the library "s << library_path << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (!socket_path.empty()) {
+        FitServer server(render_settings, default_degree);
+        if (!server.ServeUnixSocket(socket_path)) {
+            std::cerr << "Can't listen the socket "s << socket_path << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (serve) {
+        FitServer server(render_settings, default_degree);
+        server.ServeStream(std::cin, std::cout);
+        return 0;
+    }
+    return ProcessRequests(std::cin, std::cout, default_degree, fit_settings, library_path, render_settings,
+                           tiles_path);
+}
+
+int main(int argc, char* argv[]) {
+    std::ios::sync_with_stdio(false);
 
+    std::string trace_path;
+    const int res = Run(argc, argv, trace_path);
+    WriteProfile(trace_path);
+    return res;
 }
\ No newline at end of file
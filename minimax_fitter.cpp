@@ -0,0 +1,194 @@
+#include "minimax_fitter.h"
+#include "alloc_tracker.h"
+#include "equation_system.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace {
+
+// coefficients of the polynomial of t = (x - center) / half_width expanded to powers of x
+// the expansion is in long double, the coefficients are rounded once
+std::vector<double> ExpandScaled(const std::vector<double>& coeffs, double center, double half_width) {
+    const long double slope = 1 / static_cast<long double>(half_width);
+    const long double shift = -center * slope;
+    std::vector<long double> res;
+    for (size_t j = coeffs.size(); j-- > 0;) {
+        // res = res * (slope * x + shift) + coeffs[j]
+        std::vector<long double> next(res.size() + 1, 0.0L);
+        for (size_t i = 0; i < res.size(); ++i) {
+            next[i] += res[i] * shift;
+            next[i + 1] += res[i] * slope;
+        }
+        next[0] += coeffs[j];
+        res = std::move(next);
+    }
+    return {res.begin(), res.end()};
+}
+
+double EvaluateScaled(const std::vector<double>& coeffs, double t) {
+    double res = 0;
+    for (size_t i = coeffs.size(); i-- > 0;) {
+        res = res * t + coeffs[i];
+    }
+    return res;
+}
+
+// extrema of runs of errors of the same sign, they alternate in sign
+// the ends are dropped until size points are left, the point of the max error is always kept
+std::vector<size_t> GetAlternatingExtrema(const std::vector<double>& errors, size_t max_index, size_t size) {
+    std::vector<size_t> extrema;
+    for (size_t i = 0; i < errors.size(); ++i) {
+        if (!extrema.empty() && (errors[i] < 0) == (errors[extrema.back()] < 0)) {
+            if (std::abs(errors[i]) > std::abs(errors[extrema.back()])) {
+                extrema.back() = i;
+            }
+        } else {
+            extrema.push_back(i);
+        }
+    }
+
+    size_t begin = 0;
+    size_t end = extrema.size();
+    while (end - begin > size) {
+        const bool drop_front = extrema[end - 1] == max_index
+            || (extrema[begin] != max_index
+                && std::abs(errors[extrema[begin]]) < std::abs(errors[extrema[end - 1]]));
+        if (drop_front) {
+            ++begin;
+        } else {
+            --end;
+        }
+    }
+    return {extrema.begin() + begin, extrema.begin() + end};
+}
+
+}  // namespace
+
+std::optional<MinimaxFit> FitMinimax(const std::vector<Data>& data, size_t degree, const MinimaxSettings& settings) {
+    PROFILE_SCOPE("FitMinimax");
+    ALLOC_STAGE("fit/minimax");
+    PROFILE_COUNTER("points", data.size());
+    const size_t size = degree + 2;
+    if (data.size() < size) {
+        return std::nullopt;
+    }
+
+    std::vector<Data> points(data);
+    std::sort(points.begin(), points.end(), [](Data lhs, Data rhs) {
+        return lhs.x < rhs.x;
+    });
+
+    // errors are multiplied by the weights, so the relative error is weighted by 1 / |y|
+    std::vector<double> weights(points.size(), 1.0);
+    if (settings.error_type == ErrorType::RELATIVE) {
+        for (size_t i = 0; i < points.size(); ++i) {
+            if (points[i].y == 0) {
+                return std::nullopt;
+            }
+            weights[i] = 1 / std::abs(points[i].y);
+        }
+    }
+
+    // errors of rounding on the scale of the data are not exchanged
+    double error_floor = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        error_floor = std::max(error_floor, weights[i] * std::abs(points[i].y));
+    }
+    error_floor *= 1e-14;
+
+    const double center = (points.front().x + points.back().x) / 2;
+    double half_width = (points.back().x - points.front().x) / 2;
+    if (half_width == 0) {
+        half_width = 1;
+    }
+    std::vector<double> t(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        t[i] = (points[i].x - center) / half_width;
+    }
+
+    // Chebyshev extrema mapped to indexes of the points, kept strictly increasing
+    std::vector<size_t> reference(size);
+    const size_t last = points.size() - 1;
+    for (size_t k = 0; k < size; ++k) {
+        const double position = (1 - std::cos(std::numbers::pi * static_cast<double>(k) / static_cast<double>(size - 1))) / 2;
+        size_t index = static_cast<size_t>(std::lround(position * static_cast<double>(last)));
+        if (k > 0) {
+            index = std::max(index, reference[k - 1] + 1);
+        }
+        reference[k] = std::min(index, last - (size - 1 - k));
+    }
+
+    std::optional<MinimaxFit> res;
+    std::vector<double> best_coeffs;
+    std::vector<double> errors(points.size());
+    for (size_t iteration = 1; iteration <= settings.max_iterations; ++iteration) {
+        // p(t_k) + (-1)^k * level / w_k = y_k
+        BasicMatrix<double> matrix(size, std::vector<double>(size));
+        std::vector<double> right_part(size);
+        for (size_t k = 0; k < size; ++k) {
+            const size_t index = reference[k];
+            double power = 1;
+            for (size_t j = 0; j <= degree; ++j) {
+                matrix[k][j] = power;
+                power *= t[index];
+            }
+            matrix[k][degree + 1] = (k % 2 == 0 ? 1.0 : -1.0) / weights[index];
+            right_part[k] = points[index].y;
+        }
+        const auto lu = LuFactorization<double>::Factor(std::move(matrix));
+        if (!lu) {
+            break;
+        }
+        std::vector<double> coeffs = lu->Solve(std::move(right_part));
+        const double level = std::abs(coeffs.back());
+        coeffs.pop_back();
+
+        double max_error = 0;
+        size_t max_index = 0;
+        for (size_t i = 0; i < points.size(); ++i) {
+            errors[i] = weights[i] * (EvaluateScaled(coeffs, t[i]) - points[i].y);
+            if (std::abs(errors[i]) > max_error) {
+                max_error = std::abs(errors[i]);
+                max_index = i;
+            }
+        }
+        if (!res || max_error < res->max_error) {
+            res = MinimaxFit{Polynomial(std::vector<double>{}), max_error, iteration};
+            best_coeffs = coeffs;
+        }
+        if (max_error <= level * (1 + settings.tolerance) + error_floor) {
+            break;
+        }
+
+        std::vector<size_t> next_reference = GetAlternatingExtrema(errors, max_index, size);
+        // less alternations than size means the error can't be levelled better
+        if (next_reference.size() < size || next_reference == reference) {
+            break;
+        }
+        reference = std::move(next_reference);
+    }
+
+    if (res) {
+        // the powers of x lose accuracy far from zero, so the error is of the returned polynomial
+        res->polynom = Polynomial(ExpandScaled(best_coeffs, center, half_width));
+        res->max_error = 0;
+        for (size_t i = 0; i < points.size(); ++i) {
+            res->max_error = std::max(res->max_error, weights[i] * std::abs(res->polynom(points[i].x) - points[i].y));
+        }
+    }
+    return res;
+}
+
+std::optional<MinimaxFit> FitMinimaxToBound(const std::vector<Data>& data, const MinimaxSettings& settings) {
+    PROFILE_SCOPE("FitMinimaxToBound");
+    for (size_t degree = 0; degree <= settings.max_degree && degree + 2 <= data.size(); ++degree) {
+        auto fit = FitMinimax(data, degree, settings);
+        if (fit && fit->max_error <= settings.max_error) {
+            return fit;
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "approximator.h"
+
+#include <optional>
+#include <vector>
+
+// polynomials of the best uniform approximation of the data by the Remez exchange algorithm
+// the max error of the minimax polynomial is the least possible for the degree,
+// so it usually meets the error bound with a lower degree than least squares
+
+enum class ErrorType {
+    ABSOLUTE,  // |p(x) - y|
+    RELATIVE  // |p(x) - y| / |y|, y must not be zero
+};
+
+struct MinimaxSettings {
+    // the error bound of FitMinimaxToBound
+    double max_error = 0;
+    ErrorType error_type = ErrorType::ABSOLUTE;
+    // the highest degree tried by FitMinimaxToBound
+    size_t max_degree = 10;
+    // maximum number of exchanges of the reference points
+    size_t max_iterations = 50;
+    // exchanges stop when the max error exceeds the levelled error of the reference by less than tolerance times
+    double tolerance = 1e-6;
+};
+
+struct MinimaxFit {
+    Polynomial polynom;
+    // max absolute or relative error of the polynom on the data
+    double max_error = 0;
+    size_t iterations = 0;
+};
+
+// minimax polynomial of the degree on the points of the data
+// the reference of degree + 2 points starts at Chebyshev nodes, every exchange solves the levelled system
+// by LU in the scaled variable t = (x - center) / half_width and takes the extrema of alternating errors
+// returns nullopt if there are less than degree + 2 points, the relative error is asked for zero y
+// or the first system is singular
+std::optional<MinimaxFit> FitMinimax(const std::vector<Data>& data, size_t degree, const MinimaxSettings& settings);
+
+// minimax polynomial of the lowest degree with the max error not over settings.max_error,
+// the error is of the polynomial in powers of x, so a higher degree is tried if the rounding of the expansion
+// breaks the bound
+// returns nullopt if no degree up to settings.max_degree meets the bound
+std::optional<MinimaxFit> FitMinimaxToBound(const std::vector<Data>& data, const MinimaxSettings& settings);
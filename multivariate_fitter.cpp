@@ -0,0 +1,222 @@
+#include "multivariate_fitter.h"
+#include "alloc_tracker.h"
+#include "batched_solver.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+
+namespace {
+
+// number of points processed together by the vectorised loops
+const size_t BLOCK_SIZE = 256;
+
+void AddExponents(size_t dim, size_t degree, size_t remaining, std::vector<size_t>& exponents,
+                  std::vector<std::vector<size_t>>& res) {
+    if (dim == exponents.size()) {
+        res.push_back(exponents);
+        return;
+    }
+    for (size_t e = 0; e <= std::min(degree, remaining); ++e) {
+        exponents[dim] = e;
+        AddExponents(dim + 1, degree, remaining - e, exponents, res);
+    }
+}
+
+// returns the maximum total degree which is left to the next variables
+size_t GetRemaining(MonomialSet set, size_t degree) {
+    return set == MonomialSet::TOTAL_DEGREE ? degree : std::numeric_limits<size_t>::max();
+}
+
+}  // namespace
+
+std::vector<std::vector<size_t>> GetMonomialExponents(size_t dimensions, size_t degree, MonomialSet set) {
+    std::vector<std::vector<size_t>> res;
+    std::vector<size_t> exponents(dimensions);
+    AddExponents(0, degree, GetRemaining(set, degree), exponents, res);
+    return res;
+}
+
+// ********** methods of class MultiPolynomial  ************
+MultiPolynomial::MultiPolynomial(size_t dimensions, size_t degree, MonomialSet set, std::vector<double> coeffs)
+        : dimensions_{dimensions},
+          degree_{degree},
+          set_{set},
+          coeffs_{std::move(coeffs)},
+          strides_(dimensions) {
+    size_t stride = 1;
+    for (size_t i = dimensions_; i-- > 0;) {
+        strides_[i] = stride;
+        stride *= degree_ + 1;
+    }
+}
+
+double MultiPolynomial::GetCoeff(const std::vector<size_t>& exponents) const {
+    size_t index = 0;
+    for (size_t i = 0; i < dimensions_; ++i) {
+        index += exponents[i] * strides_[i];
+    }
+    return coeffs_[index];
+}
+
+// sum over e of x[dim]^e * (polynomial of the next variables), by Horner's method
+double MultiPolynomial::EvaluateLevel(const double* coeffs, size_t dim, size_t remaining, const double* x) const {
+    if (dim == dimensions_) {
+        return coeffs[0];
+    }
+    double res = 0;
+    for (size_t e = std::min(degree_, remaining) + 1; e-- > 0;) {
+        res = res * x[dim] + EvaluateLevel(coeffs + e * strides_[dim], dim + 1, remaining - e, x);
+    }
+    return res;
+}
+
+double MultiPolynomial::operator()(const double* x) const {
+    if (dimensions_ == 0) {
+        return coeffs_.empty() ? 0 : coeffs_[0];
+    }
+    return EvaluateLevel(coeffs_.data(), 0, GetRemaining(set_, degree_), x);
+}
+
+// the same as EvaluateLevel for the block of points, the result is in levels[dim]
+void MultiPolynomial::EvaluateBlockLevel(const double* coeffs, size_t dim, size_t remaining,
+                                         const std::vector<std::vector<double>>& x, size_t count,
+                                         std::vector<std::vector<double>>& levels) const {
+    std::vector<double>& res = levels[dim];
+    if (dim == dimensions_) {
+        std::fill(res.begin(), res.begin() + count, coeffs[0]);
+        return;
+    }
+    std::fill(res.begin(), res.begin() + count, 0.0);
+    const std::vector<double>& next = levels[dim + 1];
+    const std::vector<double>& x_dim = x[dim];
+    for (size_t e = std::min(degree_, remaining) + 1; e-- > 0;) {
+        EvaluateBlockLevel(coeffs + e * strides_[dim], dim + 1, remaining - e, x, count, levels);
+        for (size_t p = 0; p < count; ++p) {
+            res[p] = res[p] * x_dim[p] + next[p];
+        }
+    }
+}
+
+std::vector<double> MultiPolynomial::Evaluate(const MultiData& data) const {
+    PROFILE_SCOPE("MultiPolynomial::Evaluate");
+    const size_t count = data.GetCount();
+    std::vector<double> res(count);
+
+    // coordinates of the block by dimensions and results of every level of Horner's method
+    std::vector<std::vector<double>> x(dimensions_, std::vector<double>(BLOCK_SIZE));
+    std::vector<std::vector<double>> levels(dimensions_ + 1, std::vector<double>(BLOCK_SIZE));
+    for (size_t begin = 0; begin < count; begin += BLOCK_SIZE) {
+        const size_t block = std::min(BLOCK_SIZE, count - begin);
+        for (size_t p = 0; p < block; ++p) {
+            for (size_t j = 0; j < dimensions_; ++j) {
+                x[j][p] = data.x[(begin + p) * dimensions_ + j];
+            }
+        }
+        EvaluateBlockLevel(coeffs_.data(), 0, GetRemaining(set_, degree_), x, block, levels);
+        std::copy(levels[0].begin(), levels[0].begin() + block, res.begin() + begin);
+    }
+    return res;
+}
+
+std::optional<MultiPolynomial> FitMultivariate(const MultiData& data, size_t degree, MonomialSet set) {
+    PROFILE_SCOPE("FitMultivariate");
+    ALLOC_STAGE("fit/multivariate");
+    PROFILE_COUNTER("points", data.GetCount());
+    const size_t dimensions = data.dimensions;
+    const auto monomials = GetMonomialExponents(dimensions, degree, set);
+    const size_t size = monomials.size();
+
+    // distinct exponents of the products of two monomials, each is one moment
+    std::map<std::vector<size_t>, size_t> moment_indexes;
+    std::vector<size_t> matrix_moments(size * size);
+    for (size_t i = 0; i < size; ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            std::vector<size_t> exponents(dimensions);
+            for (size_t k = 0; k < dimensions; ++k) {
+                exponents[k] = monomials[i][k] + monomials[j][k];
+            }
+            const auto [iter, inserted] = moment_indexes.emplace(std::move(exponents), moment_indexes.size());
+            matrix_moments[i * size + j] = matrix_moments[j * size + i] = iter->second;
+        }
+    }
+    std::vector<std::vector<size_t>> moments(moment_indexes.size());
+    for (auto& [exponents, index] : moment_indexes) {
+        moments[index] = exponents;
+    }
+
+    // powers[j][k][p] = x_j^k of the point p of the block
+    const size_t max_power = 2 * degree;
+    std::vector<std::vector<std::vector<double>>> powers(
+        dimensions, std::vector<std::vector<double>>(max_power + 1, std::vector<double>(BLOCK_SIZE, 1.0)));
+    std::vector<double> product(BLOCK_SIZE);
+    std::vector<double> moment_sums(moments.size());
+    std::vector<double> right_part(size);
+
+    const size_t count = data.GetCount();
+    for (size_t begin = 0; begin < count; begin += BLOCK_SIZE) {
+        const size_t block = std::min(BLOCK_SIZE, count - begin);
+        for (size_t j = 0; j < dimensions; ++j) {
+            for (size_t k = 1; k <= max_power; ++k) {
+                const std::vector<double>& prev = powers[j][k - 1];
+                std::vector<double>& current = powers[j][k];
+                for (size_t p = 0; p < block; ++p) {
+                    current[p] = prev[p] * data.x[(begin + p) * dimensions + j];
+                }
+            }
+        }
+
+        auto fill_product = [&](const std::vector<size_t>& exponents) {
+            std::fill(product.begin(), product.begin() + block, 1.0);
+            for (size_t j = 0; j < dimensions; ++j) {
+                const std::vector<double>& power = powers[j][exponents[j]];
+                for (size_t p = 0; p < block; ++p) {
+                    product[p] *= power[p];
+                }
+            }
+        };
+
+        for (size_t m = 0; m < moments.size(); ++m) {
+            fill_product(moments[m]);
+            double sum = 0;
+            for (size_t p = 0; p < block; ++p) {
+                sum += product[p];
+            }
+            moment_sums[m] += sum;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            fill_product(monomials[i]);
+            double sum = 0;
+            for (size_t p = 0; p < block; ++p) {
+                sum += product[p] * data.y[begin + p];
+            }
+            right_part[i] += sum;
+        }
+    }
+
+    BatchedEquationSystems<double> system(size, 1);
+    for (size_t i = 0; i < size; ++i) {
+        for (size_t j = 0; j < size; ++j) {
+            system.MatrixAt(i, j, 0) = moment_sums[matrix_moments[i * size + j]];
+        }
+        system.RightPartAt(i, 0) = right_part[i];
+    }
+    if (!system.Solve()[0]) {
+        return std::nullopt;
+    }
+
+    size_t tensor_size = 1;
+    for (size_t j = 0; j < dimensions; ++j) {
+        tensor_size *= degree + 1;
+    }
+    std::vector<double> coeffs(tensor_size);
+    for (size_t i = 0; i < size; ++i) {
+        size_t index = 0;
+        for (size_t j = 0; j < dimensions; ++j) {
+            index = index * (degree + 1) + monomials[i][j];
+        }
+        coeffs[index] = system.GetSolutionAt(i, 0);
+    }
+    return MultiPolynomial(dimensions, degree, set, std::move(coeffs));
+}
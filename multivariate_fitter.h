@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// points of the function y(x1, ..., xd) of d dimensions
+// x of the point i are x[i * dimensions] ... x[i * dimensions + dimensions - 1]
+struct MultiData {
+    size_t dimensions = 0;
+    std::vector<double> x;
+    std::vector<double> y;
+
+    size_t GetCount() const {
+        return y.size();
+    }
+
+    // point must have dimensions values
+    void Add(const std::vector<double>& point, double value) {
+        x.insert(x.end(), point.begin(), point.end());
+        y.push_back(value);
+    }
+};
+
+// set of monomials x1^e1 * ... * xd^ed of the polynomial
+enum class MonomialSet {
+    TOTAL_DEGREE,  // e1 + ... + ed <= degree
+    TENSOR_PRODUCT  // every ei <= degree
+};
+
+// returns exponents of the monomials of the set, the first variable changes the slowest
+std::vector<std::vector<size_t>> GetMonomialExponents(size_t dimensions, size_t degree, MonomialSet set);
+
+// polynomial of several variables
+// coefficients are kept as a dense tensor of (degree + 1)^d elements with zeros out of the set,
+// evaluation is nested Horner's method: the outer level over x1, the inner one over xd
+class MultiPolynomial {
+public:
+    // coeffs[e1 * (degree + 1)^(d - 1) + ... + ed] is the coefficient of x1^e1 * ... * xd^ed
+    MultiPolynomial(size_t dimensions, size_t degree, MonomialSet set, std::vector<double> coeffs);
+
+    size_t GetDimensions() const {
+        return dimensions_;
+    }
+    size_t GetDegree() const {
+        return degree_;
+    }
+    MonomialSet GetMonomialSet() const {
+        return set_;
+    }
+    const std::vector<double>& GetCoeffs() const {
+        return coeffs_;
+    }
+    // returns the coefficient of the monomial with the exponents
+    double GetCoeff(const std::vector<size_t>& exponents) const;
+
+    // x has GetDimensions() values
+    double operator()(const double* x) const;
+    double operator()(const std::vector<double>& x) const {
+        return (*this)(x.data());
+    }
+
+    // evaluates all points of the data by blocks, every step of Horner's method is a loop over the block
+    std::vector<double> Evaluate(const MultiData& data) const;
+
+private:
+    double EvaluateLevel(const double* coeffs, size_t dim, size_t remaining, const double* x) const;
+    void EvaluateBlockLevel(const double* coeffs, size_t dim, size_t remaining,
+                            const std::vector<std::vector<double>>& x, size_t count,
+                            std::vector<std::vector<double>>& levels) const;
+
+    size_t dimensions_;
+    size_t degree_;
+    MonomialSet set_;
+    std::vector<double> coeffs_;
+    // strides_[i] = (degree + 1)^(d - 1 - i)
+    std::vector<size_t> strides_;
+};
+
+// least squares fit by the polynomial with the monomial set
+// all cross moments sum(x^(a + b)) and sum(x^a * y) are accumulated in one pass by blocks of points,
+// every distinct moment is summed once, and the symmetric system is solved by Cholesky decomposition
+// returns nullopt if the system is singular
+std::optional<MultiPolynomial> FitMultivariate(const MultiData& data, size_t degree,
+                                               MonomialSet set = MonomialSet::TOTAL_DEGREE);
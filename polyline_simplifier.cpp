@@ -0,0 +1,171 @@
+#include "polyline_simplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace renderer {
+
+namespace {
+// squared distance from point p to the segment ab
+double GetSquaredDistance(svg::Point p, svg::Point a, svg::Point b) {
+    const double dx = b.x - a.x;
+    const double dy = b.y - a.y;
+    const double len2 = dx * dx + dy * dy;
+
+    double t = 0;
+    if (len2 > 0) {
+        t = std::clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / len2, 0.0, 1.0);
+    }
+    const double ex = a.x + t * dx - p.x;
+    const double ey = a.y + t * dy - p.y;
+    return ex * ex + ey * ey;
+}
+
+// doubled area of the triangle abc
+double GetDoubledArea(svg::Point a, svg::Point b, svg::Point c) {
+    return std::abs((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y));
+}
+
+std::vector<svg::Point> GetKeptPoints(const std::vector<svg::Point>& points, const std::vector<bool>& keep) {
+    std::vector<svg::Point> res;
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (keep[i]) {
+            res.push_back(points[i]);
+        }
+    }
+    return res;
+}
+}  // namespace
+
+// returns points of the polyline after simplification
+std::vector<svg::Point> SimplifyPolyline(std::vector<svg::Point> points,
+                                         Simplification mode, double tolerance) {
+    if (points.size() < 3 || tolerance <= 0) {
+        return points;
+    }
+    switch (mode) {
+        case Simplification::PIXEL_GRID:
+        return SimplifyByPixelGrid(points, tolerance);
+        case Simplification::DOUGLAS_PEUCKER:
+        return SimplifyByDouglasPeucker(points, tolerance);
+        case Simplification::VISVALINGAM:
+        return SimplifyByVisvalingam(points, tolerance);
+        case Simplification::NONE:
+        break;
+    }
+    return points;
+}
+
+// removes consecutive points which fall into the same cell of size tolerance
+std::vector<svg::Point> SimplifyByPixelGrid(const std::vector<svg::Point>& points, double tolerance) {
+    std::vector<svg::Point> res;
+    if (points.empty()) {
+        return res;
+    }
+    auto get_cell = [tolerance](svg::Point p) {
+        return std::pair{std::floor(p.x / tolerance), std::floor(p.y / tolerance)};
+    };
+
+    res.push_back(points.front());
+    auto prev_cell = get_cell(points.front());
+    for (size_t i = 1; i + 1 < points.size(); ++i) {
+        const auto cell = get_cell(points[i]);
+        if (cell != prev_cell) {
+            res.push_back(points[i]);
+            prev_cell = cell;
+        }
+    }
+    if (points.size() > 1) {
+        res.push_back(points.back());
+    }
+    return res;
+}
+
+// removes points closer than tolerance to the line between kept neighbours
+std::vector<svg::Point> SimplifyByDouglasPeucker(const std::vector<svg::Point>& points, double tolerance) {
+    if (points.size() < 3) {
+        return points;
+    }
+    const double tolerance2 = tolerance * tolerance;
+    std::vector<bool> keep(points.size());
+    keep.front() = keep.back() = true;
+
+    // ranges [first, last] which are not processed yet
+    std::vector<std::pair<size_t, size_t>> ranges{{0, points.size() - 1}};
+    while (!ranges.empty()) {
+        const auto [first, last] = ranges.back();
+        ranges.pop_back();
+
+        double max_distance = 0;
+        size_t farthest = first;
+        for (size_t i = first + 1; i < last; ++i) {
+            const double distance = GetSquaredDistance(points[i], points[first], points[last]);
+            if (distance > max_distance) {
+                max_distance = distance;
+                farthest = i;
+            }
+        }
+        if (max_distance > tolerance2) {
+            keep[farthest] = true;
+            ranges.emplace_back(first, farthest);
+            ranges.emplace_back(farthest, last);
+        }
+    }
+    return GetKeptPoints(points, keep);
+}
+
+// removes points with the smallest effective area while it is less than tolerance^2
+std::vector<svg::Point> SimplifyByVisvalingam(const std::vector<svg::Point>& points, double tolerance) {
+    const size_t size = points.size();
+    if (size < 3) {
+        return points;
+    }
+    const double max_area = 2 * tolerance * tolerance;  // compare doubled areas
+
+    // doubly linked list of not removed points
+    std::vector<size_t> prev(size);
+    std::vector<size_t> next(size);
+    std::vector<double> areas(size);
+    std::vector<bool> keep(size, true);
+
+    using Item = std::pair<double, size_t>;  // area and index of point
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+
+    for (size_t i = 1; i + 1 < size; ++i) {
+        prev[i] = i - 1;
+        next[i] = i + 1;
+        areas[i] = GetDoubledArea(points[i - 1], points[i], points[i + 1]);
+        queue.emplace(areas[i], i);
+    }
+
+    auto update = [&](size_t i) {
+        if (i == 0 || i == size - 1) {
+            return;
+        }
+        areas[i] = GetDoubledArea(points[prev[i]], points[i], points[next[i]]);
+        queue.emplace(areas[i], i);
+    };
+
+    while (!queue.empty()) {
+        const auto [area, i] = queue.top();
+        queue.pop();
+        // skip removed points and outdated areas
+        if (!keep[i] || area != areas[i]) {
+            continue;
+        }
+        if (area >= max_area) {
+            break;
+        }
+        keep[i] = false;
+        next[prev[i]] = next[i];
+        prev[next[i]] = prev[i];
+        update(prev[i]);
+        update(next[i]);
+    }
+    return GetKeptPoints(points, keep);
+}
+
+}  // namespace renderer
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "svg.h"
+
+#include <vector>
+
+namespace renderer {
+
+// algorithm used to reduce the number of polyline vertices
+enum class Simplification {
+    NONE,
+    PIXEL_GRID,  // keep one vertex per run of points in the same grid cell
+    DOUGLAS_PEUCKER,  // Ramer-Douglas-Peucker, tolerance is max distance from the source line
+    VISVALINGAM,  // Visvalingam-Whyatt, tolerance^2 is min area of the triangle of a vertex
+};
+
+// returns points of the polyline after simplification
+// first and last points are always kept
+std::vector<svg::Point> SimplifyPolyline(std::vector<svg::Point> points,
+                                         Simplification mode, double tolerance);
+
+// removes consecutive points which fall into the same cell of size tolerance
+std::vector<svg::Point> SimplifyByPixelGrid(const std::vector<svg::Point>& points, double tolerance);
+
+// removes points closer than tolerance to the line between kept neighbours
+std::vector<svg::Point> SimplifyByDouglasPeucker(const std::vector<svg::Point>& points, double tolerance);
+
+// removes points with the smallest effective area while it is less than tolerance^2
+std::vector<svg::Point> SimplifyByVisvalingam(const std::vector<svg::Point>& points, double tolerance);
+
+}  // namespace renderer
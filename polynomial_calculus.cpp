@@ -0,0 +1,213 @@
+#include "polynomial_calculus.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// number of points processed together, values of the block stay in L1 cache
+const size_t BLOCK_SIZE = 256;
+
+// values of the polynomial at count points by Horner's method, the loop over points is vectorised
+template <typename T>
+void EvaluateBlock(const std::vector<T>& coeffs, const T* x, size_t count, T* values) {
+    std::fill(values, values + count, T{0});
+    for (size_t k = coeffs.size(); k-- > 0;) {
+        const T coeff = coeffs[k];
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = values[i] * x[i] + coeff;
+        }
+    }
+}
+
+}  // namespace
+
+template <typename T>
+BasicPolynomial<T> GetDerivative(const BasicPolynomial<T>& polynom) {
+    if (polynom.coeffs.size() <= 1) {
+        return BasicPolynomial<T>(std::vector<T>{0});
+    }
+    std::vector<T> coeffs(polynom.coeffs.size() - 1);
+    for (size_t i = 0; i < coeffs.size(); ++i) {
+        coeffs[i] = polynom.coeffs[i + 1] * static_cast<T>(i + 1);
+    }
+    return BasicPolynomial<T>(std::move(coeffs));
+}
+
+template <typename T>
+BasicPolynomial<T> GetAntiderivative(const BasicPolynomial<T>& polynom, std::type_identity_t<T> constant) {
+    std::vector<T> coeffs(polynom.coeffs.size() + 1);
+    coeffs[0] = constant;
+    for (size_t i = 0; i < polynom.coeffs.size(); ++i) {
+        coeffs[i + 1] = polynom.coeffs[i] / static_cast<T>(i + 1);
+    }
+    return BasicPolynomial<T>(std::move(coeffs));
+}
+
+template <typename T>
+std::vector<T> EvaluateDerivatives(const BasicPolynomial<T>& polynom, std::type_identity_t<T> x, size_t order) {
+    // d[j] accumulates p^(j)(x) / j!, every coefficient updates the higher orders first
+    std::vector<T> res(order + 1, T{0});
+    const size_t size = polynom.coeffs.size();
+    for (size_t k = size; k-- > 0;) {
+        for (size_t j = std::min(order, size - 1 - k); j > 0; --j) {
+            res[j] = res[j] * x + res[j - 1];
+        }
+        res[0] = res[0] * x + polynom.coeffs[k];
+    }
+    T factorial = 1;
+    for (size_t j = 2; j <= order; ++j) {
+        factorial *= static_cast<T>(j);
+        res[j] *= factorial;
+    }
+    return res;
+}
+
+template <typename T>
+BasicMatrix<T> EvaluateDerivatives(const BasicPolynomial<T>& polynom, const std::vector<T>& x, size_t order) {
+    PROFILE_SCOPE("EvaluateDerivatives");
+    PROFILE_COUNTER("points", x.size());
+    BasicMatrix<T> res(order + 1, std::vector<T>(x.size(), T{0}));
+    const size_t size = polynom.coeffs.size();
+
+    for (size_t begin = 0; begin < x.size(); begin += BLOCK_SIZE) {
+        const size_t count = std::min(BLOCK_SIZE, x.size() - begin);
+        const T* block_x = x.data() + begin;
+        for (size_t k = size; k-- > 0;) {
+            for (size_t j = std::min(order, size - 1 - k); j > 0; --j) {
+                T* values = res[j].data() + begin;
+                const T* lower = res[j - 1].data() + begin;
+                for (size_t i = 0; i < count; ++i) {
+                    values[i] = values[i] * block_x[i] + lower[i];
+                }
+            }
+            T* values = res[0].data() + begin;
+            const T coeff = polynom.coeffs[k];
+            for (size_t i = 0; i < count; ++i) {
+                values[i] = values[i] * block_x[i] + coeff;
+            }
+        }
+    }
+
+    T factorial = 1;
+    for (size_t j = 2; j <= order; ++j) {
+        factorial *= static_cast<T>(j);
+        for (T& value : res[j]) {
+            value *= factorial;
+        }
+    }
+    return res;
+}
+
+template <typename T>
+T Integrate(const BasicPolynomial<T>& polynom, std::type_identity_t<T> a, std::type_identity_t<T> b) {
+    const BasicPolynomial<T> antiderivative = GetAntiderivative(polynom);
+    return antiderivative(b) - antiderivative(a);
+}
+
+template <typename T>
+std::vector<T> Integrate(const BasicPolynomial<T>& polynom, const std::vector<T>& a, const std::vector<T>& b) {
+    PROFILE_SCOPE("Integrate");
+    PROFILE_COUNTER("points", a.size());
+    // every lower bound needs its upper one, b is read at the indexes of a
+    if (a.size() != b.size()) {
+        return {};
+    }
+    const BasicPolynomial<T> antiderivative = GetAntiderivative(polynom);
+    std::vector<T> res(a.size());
+    T lower[BLOCK_SIZE];
+    for (size_t begin = 0; begin < a.size(); begin += BLOCK_SIZE) {
+        const size_t count = std::min(BLOCK_SIZE, a.size() - begin);
+        EvaluateBlock(antiderivative.coeffs, a.data() + begin, count, lower);
+        EvaluateBlock(antiderivative.coeffs, b.data() + begin, count, res.data() + begin);
+        for (size_t i = 0; i < count; ++i) {
+            res[begin + i] -= lower[i];
+        }
+    }
+    return res;
+}
+
+template <typename T>
+BasicInverseSolution<T> SolveInverse(const BasicPolynomial<T>& polynom, const std::vector<T>& y,
+                                     std::type_identity_t<T> min_x, std::type_identity_t<T> max_x,
+                                     const InverseSettings& settings) {
+    PROFILE_SCOPE("SolveInverse");
+    PROFILE_COUNTER("points", y.size());
+    BasicInverseSolution<T> res;
+    res.x.assign(y.size(), T{0});
+    res.found.assign(y.size(), false);
+
+    const BasicPolynomial<T> derivative = GetDerivative(polynom);
+    const T width_tolerance = static_cast<T>(settings.tolerance) * (max_x - min_x);
+    const T value_at_min = polynom(min_x);
+    const T value_at_max = polynom(max_x);
+
+    // bracket [low, high] with p(low) - y <= 0 <= p(high) - y, low may be greater than high
+    T low[BLOCK_SIZE];
+    T high[BLOCK_SIZE];
+    T x[BLOCK_SIZE];
+    T values[BLOCK_SIZE];
+    T slopes[BLOCK_SIZE];
+    bool active[BLOCK_SIZE];
+    for (size_t begin = 0; begin < y.size(); begin += BLOCK_SIZE) {
+        const size_t count = std::min(BLOCK_SIZE, y.size() - begin);
+        const T* target = y.data() + begin;
+
+        size_t active_count = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const T f_min = value_at_min - target[i];
+            const T f_max = value_at_max - target[i];
+            active[i] = (f_min <= 0 && f_max >= 0) || (f_min >= 0 && f_max <= 0);
+            low[i] = f_min <= 0 ? min_x : max_x;
+            high[i] = f_min <= 0 ? max_x : min_x;
+            // regula falsi start, the exact root for linear curves
+            const T span = f_max - f_min;
+            x[i] = span != 0 ? min_x - f_min * (max_x - min_x) / span : (min_x + max_x) / 2;
+            active_count += active[i];
+        }
+
+        for (size_t iteration = 0; iteration < settings.max_iterations && active_count > 0; ++iteration) {
+            EvaluateBlock(polynom.coeffs, x, count, values);
+            EvaluateBlock(derivative.coeffs, x, count, slopes);
+
+            active_count = 0;
+            for (size_t i = 0; i < count; ++i) {
+                const T f = values[i] - target[i];
+                // the bracket shrinks to the side of the sign
+                low[i] = f <= 0 ? x[i] : low[i];
+                high[i] = f >= 0 ? x[i] : high[i];
+                const T newton = x[i] - f / slopes[i];
+                const T middle = (low[i] + high[i]) / 2;
+                const T left = std::min(low[i], high[i]);
+                const T right = std::max(low[i], high[i]);
+                // bisection if the Newton step leaves the bracket or is not a number
+                const T next = newton > left && newton < right ? newton : middle;
+                const bool converged = f == 0 || right - left <= width_tolerance
+                    || std::abs(next - x[i]) <= width_tolerance;
+                x[i] = f == 0 ? x[i] : next;
+                if (active[i] && converged) {
+                    res.found[begin + i] = true;
+                    active[i] = false;
+                }
+                active_count += active[i];
+            }
+        }
+        std::copy(x, x + count, res.x.begin() + begin);
+    }
+    return res;
+}
+
+#define INSTANTIATE_POLYNOMIAL_CALCULUS(T) \
+    template BasicPolynomial<T> GetDerivative<T>(const BasicPolynomial<T>&); \
+    template BasicPolynomial<T> GetAntiderivative<T>(const BasicPolynomial<T>&, T); \
+    template std::vector<T> EvaluateDerivatives<T>(const BasicPolynomial<T>&, T, size_t); \
+    template BasicMatrix<T> EvaluateDerivatives<T>(const BasicPolynomial<T>&, const std::vector<T>&, size_t); \
+    template T Integrate<T>(const BasicPolynomial<T>&, T, T); \
+    template std::vector<T> Integrate<T>(const BasicPolynomial<T>&, const std::vector<T>&, const std::vector<T>&); \
+    template BasicInverseSolution<T> SolveInverse<T>(const BasicPolynomial<T>&, const std::vector<T>&, T, T, \
+                                                     const InverseSettings&)
+
+INSTANTIATE_POLYNOMIAL_CALCULUS(float);
+INSTANTIATE_POLYNOMIAL_CALCULUS(double);
+INSTANTIATE_POLYNOMIAL_CALCULUS(long double);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "approximator.h"
+
+#include <vector>
+
+// derivatives, integrals and inverse of polynomials
+// batch functions process points by blocks, so loops over points of a block are vectorised
+
+// returns the polynomial p'(x)
+template <typename T>
+BasicPolynomial<T> GetDerivative(const BasicPolynomial<T>& polynom);
+
+// returns the antiderivative P(x) with P(0) = constant
+template <typename T>
+BasicPolynomial<T> GetAntiderivative(const BasicPolynomial<T>& polynom, std::type_identity_t<T> constant = 0);
+
+// returns p(x), p'(x), ..., p^(order)(x) calculated in one Horner pass
+template <typename T>
+std::vector<T> EvaluateDerivatives(const BasicPolynomial<T>& polynom, std::type_identity_t<T> x, size_t order);
+
+// returns rows of p^(j)(x[i]) for j from 0 to order: res[j][i]
+template <typename T>
+BasicMatrix<T> EvaluateDerivatives(const BasicPolynomial<T>& polynom, const std::vector<T>& x, size_t order);
+
+// returns integral of the polynomial from a to b by its antiderivative
+template <typename T>
+T Integrate(const BasicPolynomial<T>& polynom, std::type_identity_t<T> a, std::type_identity_t<T> b);
+
+// returns integrals from a[i] to b[i], the antiderivative is built once
+// returns empty vector if a and b have different sizes
+template <typename T>
+std::vector<T> Integrate(const BasicPolynomial<T>& polynom, const std::vector<T>& a, const std::vector<T>& b);
+
+struct InverseSettings {
+    size_t max_iterations = 50;
+    // iterations stop when the bracket of the root is narrower than tolerance times the range
+    double tolerance = 1e-14;
+};
+
+template <typename T>
+struct BasicInverseSolution {
+    std::vector<T> x;
+    // found[i] is false if y[i] is not bracketed by p(min_x) and p(max_x) or the solver doesn't converge
+    std::vector<bool> found;
+};
+
+using InverseSolution = BasicInverseSolution<double>;
+
+// solves p(x) = y[i] for x in [min_x, max_x] for all y by safeguarded Newton's method:
+// the root is kept in the bracket where p(x) - y changes sign, the Newton step is replaced by bisection
+// when it leaves the bracket, all points take their steps together in vectorised loops
+// if p(x) - y has several roots in the range, one of them is found
+template <typename T>
+BasicInverseSolution<T> SolveInverse(const BasicPolynomial<T>& polynom, const std::vector<T>& y,
+                                     std::type_identity_t<T> min_x, std::type_identity_t<T> max_x,
+                                     const InverseSettings& settings = {});
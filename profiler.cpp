@@ -0,0 +1,262 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace profiler {
+
+using namespace std::literals;
+
+namespace {
+
+struct ScopeEvent {
+    const char* name;
+    Clock::time_point start;
+    Clock::duration duration;
+};
+
+struct CounterEvent {
+    const char* name;
+    Clock::time_point time;
+    double total;  // running total of the counter in the thread
+};
+
+struct ScopeStats {
+    size_t calls = 0;
+    Clock::duration total{};
+    Clock::duration min = Clock::duration::max();
+    Clock::duration max{};
+};
+
+struct CounterStats {
+    size_t updates = 0;
+    double total = 0;
+};
+
+// keeps the last MAX_TRACE_EVENTS events, older ones are overwritten
+template <typename Event>
+class EventRing {
+public:
+    void Push(const Event& event) {
+        if (events_.size() < MAX_TRACE_EVENTS) {
+            events_.push_back(event);
+        } else {
+            events_[next_] = event;
+            next_ = (next_ + 1) % MAX_TRACE_EVENTS;
+        }
+        ++pushed_;
+    }
+
+    // returns the kept events from the oldest one
+    std::vector<Event> GetEvents() const {
+        std::vector<Event> events;
+        events.reserve(events_.size());
+        events.insert(events.end(), events_.begin() + next_, events_.end());
+        events.insert(events.end(), events_.begin(), events_.begin() + next_);
+        return events;
+    }
+
+    size_t GetDroppedCount() const {
+        return pushed_ - events_.size();
+    }
+
+    void Clear() {
+        events_.clear();
+        next_ = 0;
+        pushed_ = 0;
+    }
+
+private:
+    std::vector<Event> events_;
+    size_t next_ = 0;  // place of the oldest event when the ring is full
+    size_t pushed_ = 0;
+};
+
+// events of one thread, the owner thread records under the mutex which nobody else holds
+// except export and reset, so the lock is not contended
+struct ThreadBuffer {
+    size_t thread_id = 0;
+    std::mutex mutex;
+    EventRing<ScopeEvent> scopes;
+    EventRing<CounterEvent> counters;
+    // statistics of all events, names are string literals
+    std::unordered_map<const char*, ScopeStats> scope_stats;
+    std::unordered_map<const char*, CounterStats> counter_stats;
+};
+
+// the time of the first event is zero in the trace
+const Clock::time_point START_TIME = Clock::now();
+
+std::mutex registry_mutex;
+std::vector<std::shared_ptr<ThreadBuffer>> registry;
+
+ThreadBuffer& GetThreadBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard lock(registry_mutex);
+        buffer->thread_id = registry.size() + 1;
+        registry.push_back(buffer);
+        return buffer;
+    }();
+    return *buffer;
+}
+
+double ToMicroseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+void WriteJsonString(std::ostream& out, std::string_view str) {
+    out << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+}  // namespace
+
+void RecordScope(const char* name, Clock::time_point start, Clock::time_point end) {
+    ThreadBuffer& buffer = GetThreadBuffer();
+    const Clock::duration duration = end - start;
+    std::lock_guard lock(buffer.mutex);
+    buffer.scopes.Push({name, start, duration});
+    ScopeStats& stats = buffer.scope_stats[name];
+    ++stats.calls;
+    stats.total += duration;
+    stats.min = std::min(stats.min, duration);
+    stats.max = std::max(stats.max, duration);
+}
+
+void AddCounter(const char* name, double value) {
+    ThreadBuffer& buffer = GetThreadBuffer();
+    const Clock::time_point time = Clock::now();
+    std::lock_guard lock(buffer.mutex);
+    CounterStats& stats = buffer.counter_stats[name];
+    ++stats.updates;
+    stats.total += value;
+    buffer.counters.Push({name, time, stats.total});
+}
+
+void Reset() {
+    std::lock_guard lock(registry_mutex);
+    for (const auto& buffer : registry) {
+        std::lock_guard buffer_lock(buffer->mutex);
+        buffer->scopes.Clear();
+        buffer->counters.Clear();
+        buffer->scope_stats.clear();
+        buffer->counter_stats.clear();
+    }
+}
+
+void WriteSummary(std::ostream& out) {
+    // sorted by names, equal literals of different translation units are merged
+    std::map<std::string_view, ScopeStats> scopes;
+    std::map<std::string_view, CounterStats> counters;
+    size_t dropped = 0;
+
+    {
+        std::lock_guard lock(registry_mutex);
+        for (const auto& buffer : registry) {
+            std::lock_guard buffer_lock(buffer->mutex);
+            for (const auto& [name, thread_stats] : buffer->scope_stats) {
+                ScopeStats& stats = scopes[name];
+                stats.calls += thread_stats.calls;
+                stats.total += thread_stats.total;
+                stats.min = std::min(stats.min, thread_stats.min);
+                stats.max = std::max(stats.max, thread_stats.max);
+            }
+            for (const auto& [name, thread_stats] : buffer->counter_stats) {
+                CounterStats& stats = counters[name];
+                stats.updates += thread_stats.updates;
+                stats.total += thread_stats.total;
+            }
+            dropped += buffer->scopes.GetDroppedCount() + buffer->counters.GetDroppedCount();
+        }
+    }
+
+    out << std::left << std::setw(40) << "scope"sv << std::right
+        << std::setw(10) << "calls"sv << std::setw(14) << "total, ms"sv
+        << std::setw(14) << "mean, us"sv << std::setw(14) << "min, us"sv
+        << std::setw(14) << "max, us"sv << '\n';
+    out << std::fixed << std::setprecision(3);
+    for (const auto& [name, stats] : scopes) {
+        out << std::left << std::setw(40) << name << std::right
+            << std::setw(10) << stats.calls
+            << std::setw(14) << ToMicroseconds(stats.total) / 1000
+            << std::setw(14) << ToMicroseconds(stats.total) / stats.calls
+            << std::setw(14) << ToMicroseconds(stats.min)
+            << std::setw(14) << ToMicroseconds(stats.max) << '\n';
+    }
+
+    if (!counters.empty()) {
+        out << '\n' << std::left << std::setw(40) << "counter"sv << std::right
+            << std::setw(10) << "updates"sv << std::setw(14) << "total"sv << '\n';
+        for (const auto& [name, stats] : counters) {
+            out << std::left << std::setw(40) << name << std::right
+                << std::setw(10) << stats.updates << std::setw(14) << stats.total << '\n';
+        }
+    }
+    if (dropped > 0) {
+        out << '\n' << dropped << " oldest events are not in the trace, it keeps the last "sv << MAX_TRACE_EVENTS
+            << " of every thread"sv << '\n';
+    }
+    out << std::defaultfloat;
+}
+
+// scopes are complete events ("ph": "X"), counters are counter events ("ph": "C") with running totals
+void WriteChromeTrace(std::ostream& out) {
+    std::lock_guard lock(registry_mutex);
+
+    out << "{\"traceEvents\": ["sv;
+    bool first = true;
+    auto begin_event = [&out, &first] {
+        out << (first ? "\n  "sv : ",\n  "sv);
+        first = false;
+    };
+    out << std::fixed << std::setprecision(3);
+
+    for (const auto& buffer : registry) {
+        // the events are copied, so the thread of the buffer doesn't wait for the output
+        std::vector<ScopeEvent> scopes;
+        std::vector<CounterEvent> counters;
+        {
+            std::lock_guard buffer_lock(buffer->mutex);
+            scopes = buffer->scopes.GetEvents();
+            counters = buffer->counters.GetEvents();
+        }
+
+        for (const ScopeEvent& event : scopes) {
+            begin_event();
+            out << "{\"name\": "sv;
+            WriteJsonString(out, event.name);
+            out << ", \"ph\": \"X\", \"pid\": 1, \"tid\": "sv << buffer->thread_id
+                << ", \"ts\": "sv << ToMicroseconds(event.start - START_TIME)
+                << ", \"dur\": "sv << ToMicroseconds(event.duration) << '}';
+        }
+
+        // totals are kept per thread, Chrome merges counter events of one name and pid into one series,
+        // so every thread gets its own series
+        for (const CounterEvent& event : counters) {
+            begin_event();
+            out << "{\"name\": "sv;
+            WriteJsonString(out, std::string(event.name) + " (thread "s + std::to_string(buffer->thread_id) + ")"s);
+            out << ", \"ph\": \"C\", \"pid\": 1, \"tid\": "sv << buffer->thread_id
+                << ", \"ts\": "sv << ToMicroseconds(event.time - START_TIME)
+                << ", \"args\": {\"value\": "sv << event.total << "}}"sv;
+        }
+    }
+    out << std::defaultfloat;
+    out << "\n]}\n"sv;
+}
+
+}  // namespace profiler
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+// low-overhead scoped timers and counters
+// macros PROFILE_SCOPE and PROFILE_COUNTER are compiled out unless APPROXIMATOR_PROFILING is defined
+// (cmake -DAPPROXIMATOR_PROFILING=ON), so the hot paths don't pay for them in regular builds
+// each thread writes events to its own buffer, the summary counts all events,
+// the trace keeps the last MAX_TRACE_EVENTS scopes and counter updates of every thread,
+// counters of every thread are separate series in the trace
+namespace profiler {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr bool IsEnabled() {
+#ifdef APPROXIMATOR_PROFILING
+    return true;
+#else
+    return false;
+#endif
+}
+
+// saves the time interval of the named scope, name must be a string literal
+void RecordScope(const char* name, Clock::time_point start, Clock::time_point end);
+
+// adds value to the named counter, name must be a string literal
+void AddCounter(const char* name, double value);
+
+// max number of scopes (and of counter updates) of one thread kept for the trace
+inline constexpr size_t MAX_TRACE_EVENTS = 1 << 16;
+
+// removes all recorded events, may be called while other threads record
+void Reset();
+
+// writes table with number of calls, total, mean, min and max time of every scope and totals of counters
+void WriteSummary(std::ostream& out);
+
+// writes events in Chrome trace JSON format (chrome://tracing, Perfetto)
+void WriteChromeTrace(std::ostream& out);
+
+// records time from construction to destruction
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char* name) : name_{name}, start_{Clock::now()} {
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() {
+        RecordScope(name_, start_, Clock::now());
+    }
+
+private:
+    const char* name_;
+    Clock::time_point start_;
+};
+
+}  // namespace profiler
+
+#ifdef APPROXIMATOR_PROFILING
+#define PROFILE_CONCAT_IMPL(lhs, rhs) lhs##rhs
+#define PROFILE_CONCAT(lhs, rhs) PROFILE_CONCAT_IMPL(lhs, rhs)
+#define PROFILE_SCOPE(name) ::profiler::ScopedTimer PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#define PROFILE_COUNTER(name, value) ::profiler::AddCounter(name, static_cast<double>(value))
+#else
+#define PROFILE_SCOPE(name) static_cast<void>(0)
+#define PROFILE_COUNTER(name, value) static_cast<void>(0)
+#endif
@@ -0,0 +1,333 @@
+#include "property_library.h"
+#include "profiler.h"
+
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace library {
+
+namespace {
+
+const char MAGIC[8] = {'A', 'P', 'X', 'L', 'I', 'B', '\0', '\0'};
+// alignment of coefficient blocks, one cache line
+const size_t BLOCK_ALIGNMENT = 64;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t entries_count;
+    uint32_t buckets_count;
+    uint32_t reserved;
+    uint64_t entries_offset;
+    uint64_t buckets_offset;
+    uint64_t names_offset;
+    uint64_t file_size;
+    uint64_t reserved_tail;
+};
+static_assert(sizeof(Header) == 64);
+
+struct Entry {
+    uint64_t name_hash;
+    uint64_t coeffs_offset;  // from the start of the file
+    uint32_t name_offset;  // from the start of names
+    uint32_t name_size;
+    uint32_t kind;
+    uint32_t coeffs_count;
+    uint32_t denominator_count;
+    uint32_t reserved;
+    double min_x;
+    double max_x;
+    uint64_t reserved_tail;
+};
+static_assert(sizeof(Entry) == 64);
+
+// FNV-1a
+uint64_t GetHash(std::string_view name) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+size_t AlignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+uint32_t GetBucketsCount(size_t entries_count) {
+    uint32_t count = 1;
+    while (count < entries_count * 2) {
+        count *= 2;
+    }
+    return count;
+}
+
+const Header& GetHeader(const char* data) {
+    return *reinterpret_cast<const Header*>(data);
+}
+
+const Entry* GetEntries(const char* data) {
+    return reinterpret_cast<const Entry*>(data + GetHeader(data).entries_offset);
+}
+
+const uint32_t* GetBuckets(const char* data) {
+    return reinterpret_cast<const uint32_t*>(data + GetHeader(data).buckets_offset);
+}
+
+// checks that all sections and blocks of entries lie inside the file
+bool IsValid(const char* data, size_t size) {
+    if (size < sizeof(Header)) {
+        return false;
+    }
+    const Header& header = GetHeader(data);
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION
+            || header.file_size != size) {
+        return false;
+    }
+
+    const uint64_t entries_count = header.entries_count;
+    const uint64_t buckets_count = header.buckets_count;
+    if (header.entries_offset % alignof(Entry) != 0 || header.entries_offset > size
+            || entries_count > (size - header.entries_offset) / sizeof(Entry)) {
+        return false;
+    }
+    if (buckets_count == 0 || (buckets_count & (buckets_count - 1)) != 0 || buckets_count < entries_count * 2
+            || header.buckets_offset % alignof(uint32_t) != 0 || header.buckets_offset > size
+            || buckets_count > (size - header.buckets_offset) / sizeof(uint32_t)) {
+        return false;
+    }
+    if (header.names_offset > size) {
+        return false;
+    }
+
+    const uint32_t* buckets = GetBuckets(data);
+    for (uint64_t i = 0; i < buckets_count; ++i) {
+        if (buckets[i] > entries_count) {
+            return false;
+        }
+    }
+
+    const Entry* entries = GetEntries(data);
+    for (uint64_t i = 0; i < entries_count; ++i) {
+        const Entry& entry = entries[i];
+        if (entry.kind > static_cast<uint32_t>(FunctionKind::RATIONAL)
+                || static_cast<uint64_t>(entry.name_offset) + entry.name_size > size - header.names_offset) {
+            return false;
+        }
+        const uint64_t coeffs_count = static_cast<uint64_t>(entry.coeffs_count) + entry.denominator_count;
+        if (entry.coeffs_offset % alignof(double) != 0 || entry.coeffs_offset > size
+                || coeffs_count > (size - entry.coeffs_offset) / sizeof(double)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double EvaluatePolynomial(std::span<const double> coeffs, double x) {
+    double res = 0;
+    for (size_t i = coeffs.size(); i-- > 0;) {
+        res = res * x + coeffs[i];
+    }
+    return res;
+}
+
+}  // namespace
+
+// ********** methods of struct FunctionView  ************
+double FunctionView::operator()(double x) const {
+    const double value = EvaluatePolynomial(coeffs, x);
+    return kind == FunctionKind::RATIONAL ? value / EvaluatePolynomial(denominator, x) : value;
+}
+
+Polynomial FunctionView::ToPolynomial() const {
+    return Polynomial(std::vector<double>(coeffs.begin(), coeffs.end()));
+}
+
+RationalFunction FunctionView::ToRationalFunction() const {
+    std::vector<double> denominator_coeffs(denominator.begin(), denominator.end());
+    if (denominator_coeffs.empty()) {
+        denominator_coeffs.push_back(1.0);
+    }
+    return RationalFunction(std::vector<double>(coeffs.begin(), coeffs.end()), std::move(denominator_coeffs));
+}
+
+// ********** methods of class LibraryWriter  ************
+bool LibraryWriter::Add(std::string name, const Polynomial& polynom, double min_x, double max_x) {
+    return Add({std::move(name), FunctionKind::POLYNOMIAL, min_x, max_x, polynom.coeffs, {}});
+}
+
+bool LibraryWriter::Add(std::string name, const RationalFunction& function, double min_x, double max_x) {
+    return Add({std::move(name), FunctionKind::RATIONAL, min_x, max_x,
+                function.GetNumerator(), function.GetDenominator()});
+}
+
+bool LibraryWriter::Add(Function function) {
+    if (!names_.insert(function.name).second) {
+        return false;
+    }
+    functions_.push_back(std::move(function));
+    return true;
+}
+
+bool LibraryWriter::Write(std::ostream& out) const {
+    PROFILE_SCOPE("LibraryWriter::Write");
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.entries_count = static_cast<uint32_t>(functions_.size());
+    header.buckets_count = GetBucketsCount(functions_.size());
+
+    // layout of sections
+    header.entries_offset = sizeof(Header);
+    header.buckets_offset = header.entries_offset + functions_.size() * sizeof(Entry);
+    header.names_offset = header.buckets_offset + header.buckets_count * sizeof(uint32_t);
+    size_t names_size = 0;
+    for (const Function& function : functions_) {
+        names_size += function.name.size();
+    }
+    size_t offset = AlignUp(header.names_offset + names_size, BLOCK_ALIGNMENT);
+
+    std::vector<Entry> entries(functions_.size());
+    std::vector<uint32_t> buckets(header.buckets_count, 0);
+    const uint32_t mask = header.buckets_count - 1;
+    size_t name_offset = 0;
+    for (size_t i = 0; i < functions_.size(); ++i) {
+        const Function& function = functions_[i];
+        Entry& entry = entries[i];
+        entry.name_hash = GetHash(function.name);
+        entry.name_offset = static_cast<uint32_t>(name_offset);
+        entry.name_size = static_cast<uint32_t>(function.name.size());
+        entry.kind = static_cast<uint32_t>(function.kind);
+        entry.coeffs_count = static_cast<uint32_t>(function.coeffs.size());
+        entry.denominator_count = static_cast<uint32_t>(function.denominator.size());
+        entry.min_x = function.min_x;
+        entry.max_x = function.max_x;
+        entry.coeffs_offset = offset;
+        name_offset += function.name.size();
+        offset = AlignUp(offset + (function.coeffs.size() + function.denominator.size()) * sizeof(double),
+                         BLOCK_ALIGNMENT);
+
+        uint32_t bucket = static_cast<uint32_t>(entry.name_hash) & mask;
+        while (buckets[bucket] != 0) {
+            bucket = (bucket + 1) & mask;
+        }
+        buckets[bucket] = static_cast<uint32_t>(i + 1);
+    }
+    header.file_size = offset;
+
+    std::string buffer(offset, '\0');
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    std::memcpy(buffer.data() + header.entries_offset, entries.data(), entries.size() * sizeof(Entry));
+    std::memcpy(buffer.data() + header.buckets_offset, buckets.data(), buckets.size() * sizeof(uint32_t));
+    for (size_t i = 0; i < functions_.size(); ++i) {
+        const Function& function = functions_[i];
+        const Entry& entry = entries[i];
+        std::memcpy(buffer.data() + header.names_offset + entry.name_offset, function.name.data(),
+                    function.name.size());
+        if (!function.coeffs.empty()) {
+            std::memcpy(buffer.data() + entry.coeffs_offset, function.coeffs.data(),
+                        function.coeffs.size() * sizeof(double));
+        }
+        if (!function.denominator.empty()) {
+            std::memcpy(buffer.data() + entry.coeffs_offset + function.coeffs.size() * sizeof(double),
+                        function.denominator.data(), function.denominator.size() * sizeof(double));
+        }
+    }
+    out.write(buffer.data(), buffer.size());
+    return static_cast<bool>(out);
+}
+
+// ********** methods of class Library  ************
+Library::Library(Library&& other) noexcept
+        : data_{std::exchange(other.data_, nullptr)}, size_{std::exchange(other.size_, 0)} {
+}
+
+Library& Library::operator=(Library&& other) noexcept {
+    if (this != &other) {
+        if (data_) {
+            munmap(const_cast<char*>(data_), size_);
+        }
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+Library::~Library() {
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+std::optional<Library> Library::Open(const std::string& path) {
+    PROFILE_SCOPE("Library::Open");
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return std::nullopt;
+    }
+    struct stat status{};
+    if (fstat(file, &status) != 0 || status.st_size <= 0) {
+        close(file);
+        return std::nullopt;
+    }
+    const size_t size = static_cast<size_t>(status.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED) {
+        return std::nullopt;
+    }
+
+    Library library(static_cast<const char*>(data), size);
+    if (!IsValid(library.data_, library.size_)) {
+        return std::nullopt;
+    }
+    return library;
+}
+
+size_t Library::GetCount() const {
+    return GetHeader(data_).entries_count;
+}
+
+FunctionView Library::GetAt(size_t index) const {
+    const Entry& entry = GetEntries(data_)[index];
+    const double* coeffs = reinterpret_cast<const double*>(data_ + entry.coeffs_offset);
+    FunctionView view;
+    view.name = std::string_view(data_ + GetHeader(data_).names_offset + entry.name_offset, entry.name_size);
+    view.kind = static_cast<FunctionKind>(entry.kind);
+    view.min_x = entry.min_x;
+    view.max_x = entry.max_x;
+    view.coeffs = std::span<const double>(coeffs, entry.coeffs_count);
+    view.denominator = std::span<const double>(coeffs + entry.coeffs_count, entry.denominator_count);
+    return view;
+}
+
+std::optional<FunctionView> Library::Find(std::string_view name) const {
+    const Header& header = GetHeader(data_);
+    const Entry* entries = GetEntries(data_);
+    const uint32_t* buckets = GetBuckets(data_);
+    const uint64_t hash = GetHash(name);
+    const uint32_t mask = header.buckets_count - 1;
+
+    // the table is at most half full, so the probe ends on the empty bucket
+    for (uint32_t bucket = static_cast<uint32_t>(hash) & mask, probes = 0; probes < header.buckets_count;
+            bucket = (bucket + 1) & mask, ++probes) {
+        const uint32_t index = buckets[bucket];
+        if (index == 0) {
+            break;
+        }
+        const Entry& entry = entries[index - 1];
+        if (entry.name_hash == hash
+                && std::string_view(data_ + header.names_offset + entry.name_offset, entry.name_size) == name) {
+            return GetAt(index - 1);
+        }
+    }
+    return std::nullopt;
+}
+
+}  // namespace library
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "approximator.h"
+#include "rational_function.h"
+
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// binary library of fitted functions with valid ranges of x, looked up by name
+// (e.g. "water/density") in O(1) straight from the memory mapped file
+//
+// layout of the file, all numbers are in the byte order of the machine:
+// header (64 bytes): magic "APXLIB\0\0", version, entries count, buckets count, offsets of the sections
+// entries (64 bytes each): hash and place of the name, kind, range of x, place of coefficients
+// buckets (uint32 each): open addressing hash table of entry index + 1, 0 is the empty bucket,
+//     the count is a power of 2 and at least twice the entries count
+// names: names of entries without separators
+// coefficients: block of every entry starts at 64 bytes alignment,
+//     numerator (or polynomial) coefficients followed by denominator coefficients
+namespace library {
+
+inline constexpr uint32_t VERSION = 1;
+
+enum class FunctionKind : uint32_t {
+    POLYNOMIAL,
+    RATIONAL
+};
+
+// function of the library, refers to the memory of the library
+struct FunctionView {
+    std::string_view name;
+    FunctionKind kind = FunctionKind::POLYNOMIAL;
+    double min_x = 0;
+    double max_x = 0;
+    std::span<const double> coeffs;  // coefficients of the polynomial or of the numerator
+    std::span<const double> denominator;  // empty for polynomials
+
+    bool Contains(double x) const {
+        return min_x <= x && x <= max_x;
+    }
+
+    // calc function value by Horner's method
+    double operator()(double x) const;
+
+    Polynomial ToPolynomial() const;
+    RationalFunction ToRationalFunction() const;
+};
+
+// collects functions and writes the library
+class LibraryWriter {
+public:
+    // returns false if the name is already added
+    bool Add(std::string name, const Polynomial& polynom, double min_x, double max_x);
+    bool Add(std::string name, const RationalFunction& function, double min_x, double max_x);
+
+    size_t GetCount() const {
+        return functions_.size();
+    }
+
+    // returns false if the stream fails
+    bool Write(std::ostream& out) const;
+
+private:
+    struct Function {
+        std::string name;
+        FunctionKind kind;
+        double min_x;
+        double max_x;
+        std::vector<double> coeffs;
+        std::vector<double> denominator;
+    };
+
+    bool Add(Function function);
+
+    std::vector<Function> functions_;
+    std::unordered_set<std::string> names_;  // names of functions_ for the check of duplicates
+};
+
+// read-only library mapped to memory, nothing is copied on opening
+class Library {
+public:
+    Library(Library&& other) noexcept;
+    Library& operator=(Library&& other) noexcept;
+    Library(const Library&) = delete;
+    Library& operator=(const Library&) = delete;
+    ~Library();
+
+    // maps the file and checks the header and bounds of all sections
+    // returns nullopt if the file can't be mapped or is not a valid library of this version
+    static std::optional<Library> Open(const std::string& path);
+
+    size_t GetCount() const;
+    FunctionView GetAt(size_t index) const;
+
+    // returns nullopt if there is no function with the name
+    std::optional<FunctionView> Find(std::string_view name) const;
+
+private:
+    Library(const char* data, size_t size)
+        : data_{data}, size_{size} {
+    }
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+}  // namespace library
@@ -0,0 +1,410 @@
+#include "raster.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <string>
+#include <string_view>
+
+namespace raster {
+
+using namespace std::literals;
+
+namespace {
+
+struct NamedColor {
+    std::string_view name;
+    svg::Rgb color;
+};
+
+const std::array<NamedColor, 18> NAMED_COLORS{{
+    {"black"sv, {0, 0, 0}},
+    {"white"sv, {255, 255, 255}},
+    {"red"sv, {255, 0, 0}},
+    {"green"sv, {0, 128, 0}},
+    {"lime"sv, {0, 255, 0}},
+    {"blue"sv, {0, 0, 255}},
+    {"yellow"sv, {255, 255, 0}},
+    {"cyan"sv, {0, 255, 255}},
+    {"magenta"sv, {255, 0, 255}},
+    {"gray"sv, {128, 128, 128}},
+    {"grey"sv, {128, 128, 128}},
+    {"orange"sv, {255, 165, 0}},
+    {"purple"sv, {128, 0, 128}},
+    {"brown"sv, {165, 42, 42}},
+    {"navy"sv, {0, 0, 128}},
+    {"silver"sv, {192, 192, 192}},
+    {"lightgray"sv, {211, 211, 211}},  // default color of the confidence band
+    {"lightgrey"sv, {211, 211, 211}},
+}};
+
+std::optional<int> HexDigit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return std::nullopt;
+}
+
+// parses #rgb and #rrggbb
+std::optional<svg::Rgb> ParseHexColor(std::string_view str) {
+    if (str.empty() || str[0] != '#') {
+        return std::nullopt;
+    }
+    str.remove_prefix(1);
+    if (str.size() != 3 && str.size() != 6) {
+        return std::nullopt;
+    }
+    std::array<uint8_t, 3> channels{};
+    const size_t digits = str.size() / 3;
+    for (size_t i = 0; i < 3; ++i) {
+        int value = 0;
+        for (size_t j = 0; j < digits; ++j) {
+            const auto digit = HexDigit(str[i * digits + j]);
+            if (!digit) {
+                return std::nullopt;
+            }
+            value = value * 16 + *digit;
+        }
+        channels[i] = static_cast<uint8_t>(digits == 1 ? value * 17 : value);
+    }
+    return svg::Rgb(channels[0], channels[1], channels[2]);
+}
+
+std::optional<Paint> ParseColorString(const std::string& str) {
+    std::string lower(str.size(), ' ');
+    std::transform(str.begin(), str.end(), lower.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+
+    if (lower == svg::NoneColor) {
+        return std::nullopt;
+    }
+    if (auto color = ParseHexColor(lower)) {
+        return Paint{*color, 1.0};
+    }
+    const auto iter = std::find_if(NAMED_COLORS.begin(), NAMED_COLORS.end(),
+        [&lower](const NamedColor& named) {
+            return named.name == lower;
+    });
+    if (iter != NAMED_COLORS.end()) {
+        return Paint{iter->color, 1.0};
+    }
+    return Paint{};
+}
+
+struct PaintVisitor {
+    std::optional<Paint> operator()(std::monostate) const {
+        return std::nullopt;
+    }
+    std::optional<Paint> operator()(const std::string& color) const {
+        return ParseColorString(color);
+    }
+    std::optional<Paint> operator()(const svg::Rgb& color) const {
+        return Paint{color, 1.0};
+    }
+    std::optional<Paint> operator()(const svg::Rgba& color) const {
+        return Paint{color, color.opacity};
+    }
+};
+
+// coverage of a pixel whose center is on the distance from the edge of a figure
+double GetCoverage(double distance_outside) {
+    return std::clamp(0.5 - distance_outside, 0.0, 1.0);
+}
+
+void PutUint16(std::ostream& out, uint16_t value) {
+    out.put(static_cast<char>(value & 0xFF));
+    out.put(static_cast<char>(value >> 8));
+}
+
+void PutUint32(std::ostream& out, uint32_t value) {
+    PutUint16(out, static_cast<uint16_t>(value & 0xFFFF));
+    PutUint16(out, static_cast<uint16_t>(value >> 16));
+}
+
+void AppendUint32BigEndian(std::string& str, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        str += static_cast<char>((value >> shift) & 0xFF);
+    }
+}
+
+const std::array<uint32_t, 256> CRC_TABLE = [] {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}();
+
+uint32_t UpdateCrc(uint32_t crc, std::string_view data) {
+    for (unsigned char c : data) {
+        crc = CRC_TABLE[(crc ^ c) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+// writes png chunk: length, type, data and crc of type and data
+void WritePngChunk(std::ostream& out, std::string_view type, std::string_view data) {
+    std::string header;
+    AppendUint32BigEndian(header, static_cast<uint32_t>(data.size()));
+    out << header << type << data;
+
+    const uint32_t crc = UpdateCrc(UpdateCrc(0xFFFFFFFFu, type), data) ^ 0xFFFFFFFFu;
+    std::string footer;
+    AppendUint32BigEndian(footer, crc);
+    out << footer;
+}
+
+}  // namespace
+
+// converts svg color to paint, returns nullopt for "none" color
+std::optional<Paint> ToPaint(const svg::Color& color) {
+    return std::visit(PaintVisitor{}, color);
+}
+
+// ---------- Image -------------------
+Image::Image(size_t width, size_t height, svg::Rgb background)
+        : width_{width}, height_{height}, pixels_(width * height * 3) {
+    for (size_t i = 0; i < pixels_.size(); i += 3) {
+        pixels_[i] = background.red;
+        pixels_[i + 1] = background.green;
+        pixels_[i + 2] = background.blue;
+    }
+}
+
+svg::Rgb Image::GetPixel(size_t x, size_t y) const {
+    const size_t pos = (y * width_ + x) * 3;
+    return {pixels_[pos], pixels_[pos + 1], pixels_[pos + 2]};
+}
+
+void Image::BlendPixel(long long x, long long y, const Paint& paint, double coverage) {
+    if (x < 0 || y < 0 || x >= static_cast<long long>(width_) || y >= static_cast<long long>(height_)) {
+        return;
+    }
+    const double alpha = std::clamp(coverage * paint.opacity, 0.0, 1.0);
+    if (alpha <= 0) {
+        return;
+    }
+    uint8_t* pixel = &pixels_[(y * width_ + x) * 3];
+    auto blend = [alpha](uint8_t dst, uint8_t src) {
+        return static_cast<uint8_t>(std::lround(dst + (src - dst) * alpha));
+    };
+    pixel[0] = blend(pixel[0], paint.color.red);
+    pixel[1] = blend(pixel[1], paint.color.green);
+    pixel[2] = blend(pixel[2], paint.color.blue);
+}
+
+// draws line segment with the width
+// walks along the major axis and covers pixels by their distance to the segment
+void Image::DrawLine(svg::Point from, svg::Point to, const Paint& paint, double width) {
+    const double half_width = std::max(width, 1.0) / 2;
+    const bool steep = std::abs(to.y - from.y) > std::abs(to.x - from.x);
+    if (steep) {
+        std::swap(from.x, from.y);
+        std::swap(to.x, to.y);
+    }
+    if (from.x > to.x) {
+        std::swap(from, to);
+    }
+
+    const double dx = to.x - from.x;
+    const double dy = to.y - from.y;
+    const double length2 = dx * dx + dy * dy;
+    const double slope = dx > 0 ? dy / dx : 0;
+    // half of the covered span along the minor axis
+    const double span = half_width * std::sqrt(1 + slope * slope) + 1;
+
+    const long long first = static_cast<long long>(std::floor(from.x - half_width));
+    const long long last = static_cast<long long>(std::ceil(to.x + half_width));
+    for (long long major = first; major <= last; ++major) {
+        const double center_major = major + 0.5;
+        const double line_minor = from.y + slope * std::clamp(center_major - from.x, 0.0, dx);
+
+        const long long minor_first = static_cast<long long>(std::floor(line_minor - span));
+        const long long minor_last = static_cast<long long>(std::ceil(line_minor + span));
+        for (long long minor = minor_first; minor <= minor_last; ++minor) {
+            const double center_minor = minor + 0.5;
+            double t = 0;
+            if (length2 > 0) {
+                t = std::clamp(((center_major - from.x) * dx + (center_minor - from.y) * dy) / length2, 0.0, 1.0);
+            }
+            const double distance = std::hypot(from.x + t * dx - center_major, from.y + t * dy - center_minor);
+            const double coverage = GetCoverage(distance - half_width);
+            if (steep) {
+                BlendPixel(minor, major, paint, coverage);
+            } else {
+                BlendPixel(major, minor, paint, coverage);
+            }
+        }
+    }
+}
+
+// draws filled circle
+void Image::FillCircle(svg::Point center, double radius, const Paint& paint) {
+    const long long left = static_cast<long long>(std::floor(center.x - radius - 1));
+    const long long right = static_cast<long long>(std::ceil(center.x + radius + 1));
+    const long long top = static_cast<long long>(std::floor(center.y - radius - 1));
+    const long long bottom = static_cast<long long>(std::ceil(center.y + radius + 1));
+
+    for (long long y = top; y <= bottom; ++y) {
+        for (long long x = left; x <= right; ++x) {
+            const double distance = std::hypot(x + 0.5 - center.x, y + 0.5 - center.y);
+            BlendPixel(x, y, paint, GetCoverage(distance - radius));
+        }
+    }
+}
+
+// fills the area between two edges given by points of the same x from left to right
+// every column takes the edges at its center, pixels are covered by their overlap with the band
+void Image::FillBand(const std::vector<svg::Point>& upper, const std::vector<svg::Point>& lower,
+                     const Paint& paint) {
+    if (upper.size() < 2 || upper.size() != lower.size()) {
+        return;
+    }
+    const long long first = static_cast<long long>(std::floor(upper.front().x));
+    const long long last = static_cast<long long>(std::ceil(upper.back().x));
+    size_t segment = 1;
+    for (long long x = first; x <= last; ++x) {
+        const double center = x + 0.5;
+        if (center < upper.front().x || center > upper.back().x) {
+            continue;
+        }
+        while (segment + 1 < upper.size() && upper[segment].x < center) {
+            ++segment;
+        }
+        const double dx = upper[segment].x - upper[segment - 1].x;
+        const double t = dx > 0 ? (center - upper[segment - 1].x) / dx : 0;
+        const double y1 = upper[segment - 1].y + (upper[segment].y - upper[segment - 1].y) * t;
+        const double y2 = lower[segment - 1].y + (lower[segment].y - lower[segment - 1].y) * t;
+        const double top = std::min(y1, y2);
+        const double bottom = std::max(y1, y2);
+
+        for (long long y = static_cast<long long>(std::floor(top)); y < bottom; ++y) {
+            const double coverage = std::min<double>(y + 1, bottom) - std::max<double>(y, top);
+            BlendPixel(x, y, paint, coverage);
+        }
+    }
+}
+
+void Image::Write(std::ostream& out, ImageFormat format) const {
+    switch (format) {
+        case ImageFormat::PPM:
+        WritePpm(out);
+        break;
+        case ImageFormat::BMP:
+        WriteBmp(out);
+        break;
+        case ImageFormat::PNG:
+        WritePng(out);
+        break;
+    }
+}
+
+void Image::WritePpm(std::ostream& out) const {
+    out << "P6\n"sv << width_ << ' ' << height_ << "\n255\n"sv;
+    out.write(reinterpret_cast<const char*>(pixels_.data()), pixels_.size());
+}
+
+// rows are written from bottom to top in BGR order and padded to 4 bytes
+void Image::WriteBmp(std::ostream& out) const {
+    const uint32_t row_size = static_cast<uint32_t>((width_ * 3 + 3) / 4 * 4);
+    const uint32_t image_size = row_size * static_cast<uint32_t>(height_);
+    const uint32_t headers_size = 14 + 40;
+
+    // file header
+    out << "BM"sv;
+    PutUint32(out, headers_size + image_size);
+    PutUint32(out, 0);  // reserved
+    PutUint32(out, headers_size);  // offset of pixels
+
+    // info header
+    PutUint32(out, 40);
+    PutUint32(out, static_cast<uint32_t>(width_));
+    PutUint32(out, static_cast<uint32_t>(height_));
+    PutUint16(out, 1);  // planes
+    PutUint16(out, 24);  // bits per pixel
+    PutUint32(out, 0);  // no compression
+    PutUint32(out, image_size);
+    PutUint32(out, 2835);  // 72 dpi
+    PutUint32(out, 2835);
+    PutUint32(out, 0);  // colors in palette
+    PutUint32(out, 0);  // important colors
+
+    std::string row(row_size, '\0');
+    for (size_t y = height_; y-- > 0;) {
+        const uint8_t* src = &pixels_[y * width_ * 3];
+        for (size_t x = 0; x < width_; ++x) {
+            row[x * 3] = static_cast<char>(src[x * 3 + 2]);
+            row[x * 3 + 1] = static_cast<char>(src[x * 3 + 1]);
+            row[x * 3 + 2] = static_cast<char>(src[x * 3]);
+        }
+        out << row;
+    }
+}
+
+// image data is a zlib stream of stored deflate blocks, each row starts with filter type 0
+void Image::WritePng(std::ostream& out) const {
+    out << "\x89PNG\r\n\x1A\n"sv;
+
+    std::string header;
+    AppendUint32BigEndian(header, static_cast<uint32_t>(width_));
+    AppendUint32BigEndian(header, static_cast<uint32_t>(height_));
+    header += '\x08';  // bit depth
+    header += '\x02';  // color type RGB
+    header += "\0\0\0"sv;  // compression, filter, interlace
+    WritePngChunk(out, "IHDR"sv, header);
+
+    std::string raw;
+    const size_t row_size = width_ * 3;
+    raw.reserve((row_size + 1) * height_);
+    for (size_t y = 0; y < height_; ++y) {
+        raw += '\0';
+        raw.append(reinterpret_cast<const char*>(&pixels_[y * row_size]), row_size);
+    }
+
+    const size_t max_block = 65535;
+    std::string zlib;
+    zlib.reserve(raw.size() + raw.size() / max_block * 5 + 16);
+    zlib += "\x78\x01"sv;
+
+    uint32_t adler_a = 1;
+    uint32_t adler_b = 0;
+    size_t pos = 0;
+    do {
+        const size_t size = std::min(max_block, raw.size() - pos);
+        const bool final = pos + size == raw.size();
+        zlib += static_cast<char>(final ? 1 : 0);
+        zlib += static_cast<char>(size & 0xFF);
+        zlib += static_cast<char>(size >> 8);
+        zlib += static_cast<char>(~size & 0xFF);
+        zlib += static_cast<char>((~size >> 8) & 0xFF);
+        zlib.append(raw, pos, size);
+
+        // 5552 bytes is the max count without overflow before taking the modulo
+        for (size_t i = pos; i < pos + size;) {
+            const size_t end = std::min(i + 5552, pos + size);
+            for (; i < end; ++i) {
+                adler_a += static_cast<uint8_t>(raw[i]);
+                adler_b += adler_a;
+            }
+            adler_a %= 65521;
+            adler_b %= 65521;
+        }
+        pos += size;
+    } while (pos < raw.size());
+    AppendUint32BigEndian(zlib, (adler_b << 16) | adler_a);
+
+    WritePngChunk(out, "IDAT"sv, zlib);
+    WritePngChunk(out, "IEND"sv, ""sv);
+}
+
+}  // namespace raster
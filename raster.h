@@ -0,0 +1,70 @@
+#pragma once
+
+#include "svg.h"
+
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+namespace raster {
+
+enum class ImageFormat {
+    PPM,  // binary portable pixmap (P6)
+    BMP,  // 24-bit uncompressed bitmap
+    PNG,  // RGB png with stored (not compressed) deflate blocks
+};
+
+// color with opacity, used for blending into the image
+struct Paint {
+    svg::Rgb color;
+    double opacity = 1.0;
+};
+
+// converts svg color to paint, returns nullopt for "none" color
+// supports basic color names, #rgb and #rrggbb strings, other strings are black
+std::optional<Paint> ToPaint(const svg::Color& color);
+
+// RGB image with 8 bits per channel, pixel (0, 0) is the top left corner
+// all drawing is anti-aliased and uses the same coordinates as svg
+class Image {
+public:
+    Image(size_t width, size_t height, svg::Rgb background = {255, 255, 255});
+
+    size_t GetWidth() const {
+        return width_;
+    }
+
+    size_t GetHeight() const {
+        return height_;
+    }
+
+    // returns color of the pixel, x and y must be inside the image
+    svg::Rgb GetPixel(size_t x, size_t y) const;
+
+    // blends paint into the pixel with coverage from 0 to 1, pixels outside the image are ignored
+    void BlendPixel(long long x, long long y, const Paint& paint, double coverage);
+
+    // draws line segment with the width
+    void DrawLine(svg::Point from, svg::Point to, const Paint& paint, double width);
+
+    // draws filled circle
+    void FillCircle(svg::Point center, double radius, const Paint& paint);
+
+    // fills the area between two edges given by points of the same x from left to right
+    void FillBand(const std::vector<svg::Point>& upper, const std::vector<svg::Point>& lower, const Paint& paint);
+
+    void Write(std::ostream& out, ImageFormat format) const;
+
+    void WritePpm(std::ostream& out) const;
+    void WriteBmp(std::ostream& out) const;
+    void WritePng(std::ostream& out) const;
+
+private:
+    size_t width_;
+    size_t height_;
+    // rows of RGB triples from top to bottom
+    std::vector<uint8_t> pixels_;
+};
+
+}  // namespace raster
@@ -0,0 +1,183 @@
+#include "rational_function.h"
+#include "alloc_tracker.h"
+#include "profiler.h"
+
+#include <cmath>
+
+namespace {
+
+double EvaluatePolynomial(const std::vector<double>& coeffs, double x) {
+    double res = 0;
+    for (size_t i = coeffs.size(); i-- > 0;) {
+        res = res * x + coeffs[i];
+    }
+    return res;
+}
+
+}  // namespace
+
+// ********** methods of class RationalFunction  ************
+double RationalFunction::operator()(double x) const {
+    return EvaluatePolynomial(numerator_, x) / EvaluatePolynomial(denominator_, x);
+}
+
+std::vector<double> RationalFunction::Evaluate(const std::vector<double>& x) const {
+    // the loops over points are independent, so the compiler can vectorise them
+    std::vector<double> numerator(x.size(), 0.0);
+    std::vector<double> denominator(x.size(), 0.0);
+    for (size_t i = numerator_.size(); i-- > 0;) {
+        const double coeff = numerator_[i];
+        for (size_t p = 0; p < x.size(); ++p) {
+            numerator[p] = numerator[p] * x[p] + coeff;
+        }
+    }
+    for (size_t i = denominator_.size(); i-- > 0;) {
+        const double coeff = denominator_[i];
+        for (size_t p = 0; p < x.size(); ++p) {
+            denominator[p] = denominator[p] * x[p] + coeff;
+        }
+    }
+    for (size_t p = 0; p < x.size(); ++p) {
+        numerator[p] /= denominator[p];
+    }
+    return numerator;
+}
+
+std::vector<double> RationalFunction::FindPoles(double min_x, double max_x, size_t samples_count) const {
+    std::vector<double> poles;
+    if (denominator_.size() < 2 || samples_count < 2) {
+        return poles;
+    }
+
+    const double step = (max_x - min_x) / static_cast<double>(samples_count - 1);
+    double prev_x = min_x;
+    double prev_value = EvaluatePolynomial(denominator_, prev_x);
+    if (prev_value == 0) {
+        poles.push_back(prev_x);
+    }
+    for (size_t i = 1; i < samples_count; ++i) {
+        const double x = i + 1 == samples_count ? max_x : min_x + static_cast<double>(i) * step;
+        const double value = EvaluatePolynomial(denominator_, x);
+        if (value == 0) {
+            poles.push_back(x);
+        } else if (prev_value != 0 && (value < 0) != (prev_value < 0)) {
+            // bisection until the interval can't be divided
+            double left = prev_x;
+            double right = x;
+            double left_value = prev_value;
+            for (int iteration = 0; iteration < 100; ++iteration) {
+                const double middle = (left + right) / 2;
+                if (middle <= left || middle >= right) {
+                    break;
+                }
+                const double middle_value = EvaluatePolynomial(denominator_, middle);
+                if ((middle_value < 0) == (left_value < 0)) {
+                    left = middle;
+                    left_value = middle_value;
+                } else {
+                    right = middle;
+                }
+            }
+            poles.push_back((left + right) / 2);
+        }
+        prev_x = x;
+        prev_value = value;
+    }
+    return poles;
+}
+
+std::optional<RationalFunction> FitRational(const std::vector<Data>& data, size_t numerator_degree,
+                                            size_t denominator_degree, size_t refine_iterations) {
+    PROFILE_SCOPE("FitRational");
+    ALLOC_STAGE("fit/rational");
+    PROFILE_COUNTER("points", data.size());
+    // unknowns are p0 ... pm, q1 ... qk, the row of the point is
+    // (1, x, ..., x^m, -y * x, ..., -y * x^k) and the right part is y
+    const size_t size = numerator_degree + 1 + denominator_degree;
+    if (data.size() < size) {
+        return std::nullopt;
+    }
+
+    std::vector<double> row(size);
+    std::optional<RationalFunction> res;
+    for (size_t iteration = 0; iteration <= refine_iterations; ++iteration) {
+        BasicMatrix<double> matrix(size, std::vector<double>(size));
+        std::vector<double> right_part(size);
+
+        for (const Data& point : data) {
+            double weight = 1;
+            if (res) {
+                const double denominator = EvaluatePolynomial(res->GetDenominator(), point.x);
+                weight = 1 / (denominator * denominator);
+            }
+            double x_power = 1;
+            for (size_t i = 0; i <= numerator_degree; ++i) {
+                row[i] = x_power;
+                x_power *= point.x;
+            }
+            x_power = point.x;
+            for (size_t i = 0; i < denominator_degree; ++i) {
+                row[numerator_degree + 1 + i] = -point.y * x_power;
+                x_power *= point.x;
+            }
+            // the matrix is symmetric, the lower triangle is copied after the pass
+            for (size_t i = 0; i < size; ++i) {
+                const double weighted = weight * row[i];
+                for (size_t j = 0; j <= i; ++j) {
+                    matrix[i][j] += weighted * row[j];
+                }
+                right_part[i] += weighted * point.y;
+            }
+        }
+        for (size_t i = 0; i < size; ++i) {
+            for (size_t j = i + 1; j < size; ++j) {
+                matrix[i][j] = matrix[j][i];
+            }
+        }
+
+        const auto lu = LuFactorization<double>::Factor(std::move(matrix));
+        if (!lu) {
+            // the refinement keeps the last solution
+            break;
+        }
+        const std::vector<double> solution = lu->Solve(std::move(right_part));
+        std::vector<double> numerator(solution.begin(), solution.begin() + numerator_degree + 1);
+        std::vector<double> denominator{1.0};
+        denominator.insert(denominator.end(), solution.begin() + numerator_degree + 1, solution.end());
+        res = RationalFunction(std::move(numerator), std::move(denominator));
+    }
+    return res;
+}
+
+std::vector<double> FindPoles(const RationalFunction& function, const std::vector<Data>& data) {
+    if (data.empty()) {
+        return {};
+    }
+    const auto [min_x, max_x] = GetRangeX(data);
+    return function.FindPoles(min_x, max_x);
+}
+
+double GetSumSquaredErrors(const RationalFunction& function, const std::vector<Data>& data) {
+    double sse = 0;
+    for (const Data& point : data) {
+        const double error = function(point.x) - point.y;
+        sse += error * error;
+    }
+    return sse;
+}
+
+std::vector<Data> GeneratePoints(const RationalFunction& function, double min_x, double max_x, size_t count) {
+    std::vector<Data> points;
+    points.reserve(count);
+
+    const double step = (max_x - min_x) / (count - 1);
+    double next = min_x;
+    for (size_t i = 0; i < count; ++i) {
+        const double y = function(next);
+        if (std::isfinite(y)) {
+            points.push_back({next, y});
+        }
+        next += step;
+    }
+    return points;
+}
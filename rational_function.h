@@ -0,0 +1,53 @@
+#pragma once
+
+#include "approximator.h"
+
+#include <optional>
+#include <vector>
+
+// rational function P(x) / Q(x), coefficients start from the free member
+// the free member of the denominator of fitted functions is 1
+class RationalFunction {
+public:
+    RationalFunction(std::vector<double> numerator, std::vector<double> denominator)
+        : numerator_{std::move(numerator)},
+          denominator_{std::move(denominator)} {
+    }
+
+    const std::vector<double>& GetNumerator() const {
+        return numerator_;
+    }
+    const std::vector<double>& GetDenominator() const {
+        return denominator_;
+    }
+
+    // calc function value by Horner's method for the numerator and the denominator
+    double operator()(double x) const;
+    // calc function values for all x
+    std::vector<double> Evaluate(const std::vector<double>& x) const;
+
+    // returns x in [min_x, max_x] where the denominator is zero (poles of the function)
+    // roots are found by sign changes of the denominator on samples_count points and refined by bisection
+    std::vector<double> FindPoles(double min_x, double max_x, size_t samples_count = 1000) const;
+
+private:
+    std::vector<double> numerator_;
+    std::vector<double> denominator_;
+};
+
+// least squares fit by the rational function with the degrees of the numerator and the denominator
+// the first solve minimises sum((y * Q(x) - P(x))^2), which is linear in coefficients,
+// then refine_iterations solves weight every point by 1 / Q(x)^2 of the previous solution
+// to approach the true error sum((y - P(x) / Q(x))^2)
+// returns nullopt if the system is singular
+std::optional<RationalFunction> FitRational(const std::vector<Data>& data, size_t numerator_degree,
+                                            size_t denominator_degree, size_t refine_iterations = 5);
+
+// returns poles of the function in the range of x of the data
+std::vector<double> FindPoles(const RationalFunction& function, const std::vector<Data>& data);
+
+// sum of squared errors of the function on the data
+double GetSumSquaredErrors(const RationalFunction& function, const std::vector<Data>& data);
+
+// returns count points of the function evenly spaced from min_x to max_x, points at poles are skipped
+std::vector<Data> GeneratePoints(const RationalFunction& function, double min_x, double max_x, size_t count);
@@ -0,0 +1,69 @@
+#include "request_fitter.h"
+
+#include "rational_function.h"
+
+#include <string>
+#include <tuple>
+#include <utility>
+
+using namespace std::literals;
+
+// fits the request by the settings, the name of the request is moved to the result
+io::FitResult ProcessRequest(io::FitRequest& request, const FitSettings& settings, Approximator& app) {
+    io::FitResult result;
+    if (settings.robust) {
+        if (const auto robust_fit = FitRobust(request.data, request.degree, *settings.robust)) {
+            result.outliers = GetOutlierIndexes(robust_fit->inliers);
+            request.data = SelectInliers(request.data, robust_fit->inliers);
+        }
+    }
+
+    result.name = std::move(request.name);
+    result.degree = request.degree;
+    if (!request.data.empty()) {
+        std::tie(result.min_x, result.max_x) = GetRangeX(request.data);
+    }
+
+    if (settings.rational_degree > 0) {
+        result.rational = FitRational(request.data, request.degree, settings.rational_degree);
+        if (result.rational) {
+            result.sse = GetSumSquaredErrors(*result.rational, request.data);
+            result.poles = FindPoles(*result.rational, request.data);
+        }
+        app.SetData(request.data);
+        return result;
+    }
+    if (settings.minimax) {
+        MinimaxSettings minimax = *settings.minimax;
+        minimax.max_degree = request.degree;
+        if (auto fit = FitMinimaxToBound(request.data, minimax)) {
+            result.degree = fit->polynom.coeffs.size() - 1;
+            result.max_error = fit->max_error;
+            result.sse = GetSumSquaredErrors(fit->polynom, request.data);
+            result.polynom = std::move(fit->polynom);
+        } else {
+            result.error = "no degree up to "s + std::to_string(request.degree) + " meets the error bound"s;
+        }
+        app.SetData(request.data);
+        return result;
+    }
+
+    app.SetSolveMode(settings.solve_mode);
+    if (settings.reduction) {
+        app.SetData(ReduceData(request.data, *settings.reduction));
+    } else {
+        app.SetData(request.data);
+    }
+    result.polynom = app.GetPolynom(request.degree);
+    const auto report = app.GetFitReport(ReportMode::DATA_PASS, settings.report_bins);
+    if (report) {
+        result.sse = report->sse;
+    }
+    if (settings.report_bins > 0) {
+        result.report = report;
+    }
+    if (report) {
+        result.covariance = app.GetCovariance(report->sse);
+    }
+    return result;
+}
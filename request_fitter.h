@@ -0,0 +1,27 @@
+#pragma once
+
+#include "approximator.h"
+#include "data_reader.h"
+#include "data_reducer.h"
+#include "minimax_fitter.h"
+#include "result_writer.h"
+#include "robust_fitter.h"
+
+#include <optional>
+
+// how requests are fitted, shared by the command line and the batch runner
+struct FitSettings {
+    std::optional<RobustSettings> robust;  // outliers are removed by the robust fit before the approximation
+    size_t rational_degree = 0;  // degree of the denominator of the rational fit, 0 fits polynomials
+    // data is fitted by minimax polynomials of the lowest degree up to the degree of the request meeting the error bound
+    std::optional<MinimaxSettings> minimax;
+    // diagnostics of least squares fits with the histogram of residuals of report_bins bins, 0 doesn't report them
+    size_t report_bins = 0;
+    // points of least squares fits are merged into weighted points before the fit
+    std::optional<ReductionSettings> reduction;
+    SolveMode solve_mode = SolveMode::REFINED;  // method of solving the system of least squares fits
+};
+
+// fits the request by the settings, the name of the request is moved to the result
+// the data without outliers is moved to the approximator for graphs (reduced points of least squares fits)
+io::FitResult ProcessRequest(io::FitRequest& request, const FitSettings& settings, Approximator& app);
@@ -0,0 +1,212 @@
+#include "result_writer.h"
+#include "alloc_tracker.h"
+#include "profiler.h"
+
+#include <charconv>
+#include <cmath>
+#include <string_view>
+
+namespace io {
+
+using namespace std::literals;
+
+namespace {
+
+// buffer is written to the stream when it grows over this size
+const size_t FLUSH_SIZE = 1 << 16;
+
+void AppendNumber(std::string& str, double value) {
+    if (!std::isfinite(value)) {
+        str += "null"sv;
+        return;
+    }
+    char buffer[32];
+    const auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+    str.append(buffer, end);
+}
+
+void AppendNumber(std::string& str, size_t value) {
+    char buffer[24];
+    const auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+    str.append(buffer, end);
+}
+
+void AppendString(std::string& str, std::string_view text) {
+    str += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"':
+            str += "\\\""sv;
+            break;
+            case '\\':
+            str += "\\\\"sv;
+            break;
+            case '\n':
+            str += "\\n"sv;
+            break;
+            case '\r':
+            str += "\\r"sv;
+            break;
+            case '\t':
+            str += "\\t"sv;
+            break;
+            default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                const char* digits = "0123456789abcdef";
+                str += "\\u00"sv;
+                str += digits[(c >> 4) & 0xF];
+                str += digits[c & 0xF];
+            } else {
+                str += c;
+            }
+            break;
+        }
+    }
+    str += '"';
+}
+
+void AppendNumbers(std::string& str, const std::vector<double>& values) {
+    str += '[';
+    bool first = true;
+    for (double value : values) {
+        if (!first) {
+            str += ", "sv;
+        }
+        first = false;
+        AppendNumber(str, value);
+    }
+    str += ']';
+}
+
+void AppendResult(std::string& str, const FitResult& result) {
+    str += "{\"name\": "sv;
+    AppendString(str, result.name);
+    str += ", \"degree\": "sv;
+    AppendNumber(str, result.degree);
+    if (result.rational) {
+        str += ", \"numerator\": "sv;
+        AppendNumbers(str, result.rational->GetNumerator());
+        str += ", \"denominator\": "sv;
+        AppendNumbers(str, result.rational->GetDenominator());
+        str += ", \"poles\": "sv;
+        AppendNumbers(str, result.poles);
+    } else if (result.polynom) {
+        str += ", \"coeffs\": "sv;
+        AppendNumbers(str, result.polynom->coeffs);
+    } else {
+        str += ", \"coeffs\": null, \"error\": "sv;
+        AppendString(str, result.error.empty() ? "the fit has no solution"sv : std::string_view(result.error));
+    }
+    str += ", \"sse\": "sv;
+    AppendNumber(str, result.sse);
+    if (result.covariance) {
+        const Matrix& covariance = *result.covariance;
+        str += ", \"std_errors\": ["sv;
+        for (size_t i = 0; i < covariance.size(); ++i) {
+            if (i > 0) {
+                str += ", "sv;
+            }
+            AppendNumber(str, std::sqrt(covariance[i][i]));
+        }
+        str += "], \"covariance\": ["sv;
+        for (size_t i = 0; i < covariance.size(); ++i) {
+            if (i > 0) {
+                str += ", "sv;
+            }
+            AppendNumbers(str, covariance[i]);
+        }
+        str += ']';
+    }
+    if (result.max_error) {
+        str += ", \"max_error\": "sv;
+        AppendNumber(str, *result.max_error);
+    }
+    if (result.report) {
+        str += ", \"r_squared\": "sv;
+        AppendNumber(str, result.report->r_squared);
+        str += ", \"rmse\": "sv;
+        AppendNumber(str, result.report->rmse);
+        if (result.report->max_residual) {
+            str += ", \"max_residual\": "sv;
+            AppendNumber(str, *result.report->max_residual);
+        }
+        if (!result.report->histogram.empty()) {
+            str += ", \"histogram\": ["sv;
+            for (size_t i = 0; i < result.report->histogram.size(); ++i) {
+                if (i > 0) {
+                    str += ", "sv;
+                }
+                AppendNumber(str, result.report->histogram[i]);
+            }
+            str += ']';
+        }
+    }
+    if (result.outliers) {
+        str += ", \"outliers\": ["sv;
+        for (size_t i = 0; i < result.outliers->size(); ++i) {
+            if (i > 0) {
+                str += ", "sv;
+            }
+            AppendNumber(str, (*result.outliers)[i]);
+        }
+        str += ']';
+    }
+    str += '}';
+}
+
+}  // namespace
+
+void WriteJson(std::ostream& out, const std::vector<FitResult>& results) {
+    PROFILE_SCOPE("io::WriteJson");
+    ALLOC_STAGE("write");
+    std::string buffer;
+    buffer.reserve(FLUSH_SIZE * 2);
+    buffer += '[';
+
+    bool first = true;
+    for (const FitResult& result : results) {
+        buffer += first ? "\n  "sv : ",\n  "sv;
+        first = false;
+        AppendResult(buffer, result);
+
+        if (buffer.size() > FLUSH_SIZE) {
+            out.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    buffer += first ? "]\n"sv : "\n]\n"sv;
+    out.write(buffer.data(), buffer.size());
+}
+
+std::string ToJson(const FitResult& result) {
+    std::string str;
+    AppendResult(str, result);
+    return str;
+}
+
+std::string ValuesToJson(std::string_view name, const std::vector<double>& values) {
+    std::string str = "{\"name\": "s;
+    AppendString(str, name);
+    str += ", \"y\": "sv;
+    AppendNumbers(str, values);
+    str += '}';
+    return str;
+}
+
+std::string SvgToJson(std::string_view name, std::string_view svg) {
+    std::string str = "{\"name\": "s;
+    AppendString(str, name);
+    str += ", \"svg\": "sv;
+    AppendString(str, svg);
+    str += '}';
+    return str;
+}
+
+std::string ErrorToJson(std::string_view message) {
+    std::string str = "{\"error\": "s;
+    AppendString(str, message);
+    str += '}';
+    return str;
+}
+
+}  // namespace io
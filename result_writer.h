@@ -0,0 +1,62 @@
+#pragma once
+
+#include "approximator.h"
+#include "fit_report.h"
+#include "rational_function.h"
+
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace io {
+
+// result of the approximation of one data set
+struct FitResult {
+    std::string name;
+    size_t degree = 0;
+    std::optional<Polynomial> polynom;  // empty if the system of equations has no solution
+    // why the fit has no function, written as "error" when neither polynom nor rational is found
+    std::string error;
+    double sse = 0;  // sum of squared errors
+    // range of x of the fitted data where the function is valid, not written to JSON
+    double min_x = 0;
+    double max_x = 0;
+    // covariance matrix of the coefficients, empty if there are not enough points
+    std::optional<Matrix> covariance;
+    // indexes of points removed as outliers by the robust fit, empty if the fit is not robust
+    std::optional<std::vector<size_t>> outliers;
+    // function of the rational fit, polynom is empty then
+    std::optional<RationalFunction> rational;
+    std::vector<double> poles;  // poles of the rational function in the range of the data
+    // max absolute or relative error of the minimax fit, empty for least squares fits
+    std::optional<double> max_error;
+    // diagnostics of the polynomial, empty if they are not asked for
+    std::optional<FitReport> report;
+};
+
+// writes results as JSON array:
+// [{"name": "density", "degree": 2, "coeffs": [a0, a1, a2], "sse": 0.1,
+//   "std_errors": [s0, s1, s2], "covariance": [[c00, c01, c02], ...]}, ...]
+// "coeffs" is null if the polynomial is not found and "error": "message" is written then,
+// not finite numbers are written as null
+// "std_errors" and "covariance" are written only if the covariance is known
+// "outliers": [i, j, ...] is written only for robust fits
+// rational fits are written with "numerator": [p0, ...], "denominator": [1, q1, ...], "poles": [x0, ...]
+// instead of "coeffs", "degree" is the degree of the numerator
+// "max_error" is written only for minimax fits
+// "r_squared", "rmse", "max_residual" and "histogram": [n0, n1, ...] are written only with the report
+void WriteJson(std::ostream& out, const std::vector<FitResult>& results);
+
+// one line answers of the fit server
+// {"name": "density", "degree": 2, "coeffs": [a0, a1, a2], "sse": 0.1}
+std::string ToJson(const FitResult& result);
+// {"name": "density", "y": [y0, y1, ...]}
+std::string ValuesToJson(std::string_view name, const std::vector<double>& values);
+// {"name": "density", "svg": "<?xml ..."}
+std::string SvgToJson(std::string_view name, std::string_view svg);
+// {"error": "message"}
+std::string ErrorToJson(std::string_view message);
+
+}  // namespace io
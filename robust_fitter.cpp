@@ -0,0 +1,273 @@
+#include "robust_fitter.h"
+#include "alloc_tracker.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+
+namespace {
+
+// scale of normal errors by the median of absolute deviations
+const double MAD_TO_SIGMA = 1.4826;
+const double HUBER_TUNING = 1.345;
+const double TUKEY_TUNING = 4.685;
+
+// returns the solution of the weighted least squares or nullopt if the system is singular
+std::optional<Polynomial> SolveWeighted(const std::vector<Data>& data, const std::vector<double>& weights,
+                                        size_t degree) {
+    const auto system = GetWeightedEquationSystem(data, weights, static_cast<int>(degree));
+    const auto lu = LuFactorization<double>::Factor(system.GetMatrix());
+    if (!lu) {
+        return std::nullopt;
+    }
+    return Polynomial(lu->Solve(system.GetRightPart()));
+}
+
+void FillResiduals(const std::vector<Data>& data, const Polynomial& polynom, std::vector<double>& residuals) {
+    for (size_t i = 0; i < data.size(); ++i) {
+        residuals[i] = data[i].y - polynom(data[i].x);
+    }
+}
+
+// robust scale of the residuals, buffer is used to find the median
+double GetScale(const std::vector<double>& residuals, std::vector<double>& buffer) {
+    buffer.resize(residuals.size());
+    std::transform(residuals.begin(), residuals.end(), buffer.begin(), [](double value) {
+        return std::abs(value);
+    });
+    const auto middle = buffer.begin() + buffer.size() / 2;
+    std::nth_element(buffer.begin(), middle, buffer.end());
+    return MAD_TO_SIGMA * *middle;
+}
+
+// threshold of inliers, for exact fits the scale is zero and rounding errors must not become outliers
+double GetThreshold(const std::vector<Data>& data, double scale, const RobustSettings& settings) {
+    double max_y = 0;
+    for (const Data& point : data) {
+        max_y = std::max(max_y, std::abs(point.y));
+    }
+    return std::max(settings.outlier_threshold * scale, 1e-12 * max_y);
+}
+
+std::vector<bool> GetInliers(const std::vector<double>& residuals, double threshold) {
+    std::vector<bool> inliers(residuals.size());
+    for (size_t i = 0; i < residuals.size(); ++i) {
+        inliers[i] = std::abs(residuals[i]) <= threshold;
+    }
+    return inliers;
+}
+
+double GetMaxAbs(const std::vector<double>& values) {
+    double res = 0;
+    for (double value : values) {
+        res = std::max(res, std::abs(value));
+    }
+    return res;
+}
+
+// best sample of one RANSAC thread
+struct Candidate {
+    std::optional<Polynomial> polynom;
+    double scale = 0;  // robust scale of residuals of all points
+
+    bool IsBetter(const Candidate& other) const {
+        return polynom && (!other.polynom || scale < other.scale);
+    }
+};
+
+// interpolates samples_count random samples and returns the one with the least median of residuals
+// the median doesn't need a threshold of inliers which is unknown before the fit
+Candidate FindCandidate(const std::vector<Data>& data, size_t degree, size_t samples_count, uint64_t seed) {
+    const size_t size = degree + 1;
+    std::mt19937_64 gen(seed);
+    std::uniform_int_distribution<size_t> index_dis(0, data.size() - 1);
+
+    std::vector<size_t> sample(size);
+    BasicMatrix<double> vandermonde(size, std::vector<double>(size));
+    std::vector<double> right_part(size);
+    std::vector<double> residuals(data.size());
+    std::vector<double> buffer;
+
+    Candidate best;
+    for (size_t iteration = 0; iteration < samples_count; ++iteration) {
+        // distinct indexes, the sample is small so the linear search is fast
+        for (size_t i = 0; i < size; ++i) {
+            do {
+                sample[i] = index_dis(gen);
+            } while (std::find(sample.begin(), sample.begin() + i, sample[i]) != sample.begin() + i);
+        }
+
+        for (size_t i = 0; i < size; ++i) {
+            const Data& point = data[sample[i]];
+            double x_power = 1;
+            for (double& value : vandermonde[i]) {
+                value = x_power;
+                x_power *= point.x;
+            }
+            right_part[i] = point.y;
+        }
+        const auto lu = LuFactorization<double>::Factor(vandermonde);
+        if (!lu) {
+            continue;
+        }
+
+        Candidate candidate;
+        candidate.polynom = Polynomial(lu->Solve(right_part));
+        FillResiduals(data, *candidate.polynom, residuals);
+        candidate.scale = GetScale(residuals, buffer);
+        if (candidate.IsBetter(best)) {
+            best = std::move(candidate);
+        }
+    }
+    return best;
+}
+
+}  // namespace
+
+std::optional<RobustFit> FitIrls(const std::vector<Data>& data, size_t degree, const RobustSettings& settings) {
+    PROFILE_SCOPE("FitIrls");
+    ALLOC_STAGE("fit/robust");
+    if (data.size() <= degree) {
+        return std::nullopt;
+    }
+    const bool huber = settings.method != RobustMethod::TUKEY;
+    const double tuning = settings.tuning > 0 ? settings.tuning : (huber ? HUBER_TUNING : TUKEY_TUNING);
+
+    std::vector<double> weights(data.size(), 1.0);
+    std::vector<double> residuals(data.size());
+    std::vector<double> buffer;
+
+    auto polynom = SolveWeighted(data, weights, degree);
+    if (!polynom) {
+        return std::nullopt;
+    }
+    FillResiduals(data, *polynom, residuals);
+    double scale = GetScale(residuals, buffer);
+
+    size_t iteration = 0;
+    while (iteration < settings.max_iterations && scale > 0) {
+        ++iteration;
+        const double limit = tuning * scale;
+        for (size_t i = 0; i < data.size(); ++i) {
+            const double u = std::abs(residuals[i]) / limit;
+            if (huber) {
+                weights[i] = u <= 1 ? 1.0 : 1.0 / u;
+            } else {
+                const double v = u < 1 ? 1 - u * u : 0.0;
+                weights[i] = v * v;
+            }
+        }
+
+        auto next = SolveWeighted(data, weights, degree);
+        if (!next) {
+            break;
+        }
+        double change = 0;
+        for (size_t i = 0; i < next->coeffs.size(); ++i) {
+            change = std::max(change, std::abs(next->coeffs[i] - polynom->coeffs[i]));
+        }
+        polynom = std::move(next);
+        FillResiduals(data, *polynom, residuals);
+        scale = GetScale(residuals, buffer);
+        if (change <= settings.tolerance * GetMaxAbs(polynom->coeffs)) {
+            break;
+        }
+    }
+
+    return RobustFit{
+        .polynom = std::move(*polynom),
+        .inliers = GetInliers(residuals, GetThreshold(data, scale, settings)),
+        .iterations = iteration,
+        .scale = scale
+    };
+}
+
+std::optional<RobustFit> FitRansac(const std::vector<Data>& data, size_t degree, const RobustSettings& settings) {
+    PROFILE_SCOPE("FitRansac");
+    ALLOC_STAGE("fit/robust");
+    if (data.size() <= degree) {
+        return std::nullopt;
+    }
+
+    const size_t threads_count = std::max<size_t>(
+        settings.threads_count ? settings.threads_count : std::thread::hardware_concurrency(), 1);
+    std::vector<Candidate> candidates(threads_count);
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(threads_count);
+        for (size_t i = 0; i < threads_count; ++i) {
+            // the samples are split evenly, the first threads take the remainder
+            const size_t samples_count = settings.ransac_samples / threads_count
+                                         + (i < settings.ransac_samples % threads_count ? 1 : 0);
+            threads.emplace_back([&, i, samples_count] {
+                candidates[i] = FindCandidate(data, degree, samples_count, settings.seed + i);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    Candidate best;
+    for (Candidate& candidate : candidates) {
+        if (candidate.IsBetter(best)) {
+            best = std::move(candidate);
+        }
+    }
+    if (!best.polynom) {
+        return std::nullopt;
+    }
+
+    // least squares on the inliers of the best sample
+    std::vector<double> residuals(data.size());
+    std::vector<double> buffer;
+    FillResiduals(data, *best.polynom, residuals);
+    const double threshold = GetThreshold(data, best.scale, settings);
+    std::vector<double> weights(data.size());
+    for (size_t i = 0; i < data.size(); ++i) {
+        weights[i] = std::abs(residuals[i]) <= threshold ? 1.0 : 0.0;
+    }
+    auto polynom = SolveWeighted(data, weights, degree);
+    if (!polynom) {
+        polynom = std::move(best.polynom);
+    }
+    FillResiduals(data, *polynom, residuals);
+    const double scale = GetScale(residuals, buffer);
+
+    return RobustFit{
+        .polynom = std::move(*polynom),
+        .inliers = GetInliers(residuals, GetThreshold(data, scale, settings)),
+        .iterations = settings.ransac_samples,
+        .scale = scale
+    };
+}
+
+std::optional<RobustFit> FitRobust(const std::vector<Data>& data, size_t degree, const RobustSettings& settings) {
+    if (settings.method == RobustMethod::RANSAC) {
+        return FitRansac(data, degree, settings);
+    }
+    return FitIrls(data, degree, settings);
+}
+
+std::vector<Data> SelectInliers(const std::vector<Data>& data, const std::vector<bool>& inliers) {
+    std::vector<Data> res;
+    res.reserve(data.size());
+    for (size_t i = 0; i < data.size(); ++i) {
+        if (inliers[i]) {
+            res.push_back(data[i]);
+        }
+    }
+    return res;
+}
+
+std::vector<size_t> GetOutlierIndexes(const std::vector<bool>& inliers) {
+    std::vector<size_t> res;
+    for (size_t i = 0; i < inliers.size(); ++i) {
+        if (!inliers[i]) {
+            res.push_back(i);
+        }
+    }
+    return res;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "approximator.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// fits which are not pulled off by outliers
+// residuals are measured in the robust scale s = 1.4826 * median(|r_i|),
+// which is the standard deviation for normal errors and doesn't depend on a few outliers
+
+enum class RobustMethod {
+    HUBER,  // IRLS with weights min(1, c / |u|), c = 1.345 by default
+    TUKEY,  // IRLS with weights (1 - u^2)^2 for |u| < 1 and 0 otherwise, c = 4.685 by default
+    RANSAC  // polynomial through random samples of degree + 1 points with the least median of residuals
+};
+
+struct RobustSettings {
+    RobustMethod method = RobustMethod::HUBER;
+    // tuning constant of the IRLS weights in robust scales, 0 means the default of the method
+    double tuning = 0;
+    // maximum number of reweighting iterations
+    size_t max_iterations = 50;
+    // iterations stop when coefficients change less than tolerance relative to their size
+    double tolerance = 1e-10;
+
+    // number of random samples of RANSAC
+    size_t ransac_samples = 500;
+    // threads of RANSAC, 0 means the number of hardware threads
+    size_t threads_count = 0;
+    uint64_t seed = 42;
+
+    // points with |r| <= outlier_threshold * s are inliers
+    double outlier_threshold = 3;
+};
+
+struct RobustFit {
+    Polynomial polynom;
+    // inliers[i] is false for outliers
+    std::vector<bool> inliers;
+    // reweighting iterations or samples of RANSAC
+    size_t iterations = 0;
+    // robust scale of residuals
+    double scale = 0;
+};
+
+// iteratively reweighted least squares with Huber or Tukey weights, starts from ordinary least squares
+// every iteration builds weighted sums of moments in one pass and solves the system by LU
+// returns nullopt if there are not more points than the degree or the system is singular
+std::optional<RobustFit> FitIrls(const std::vector<Data>& data, size_t degree, const RobustSettings& settings);
+
+// random samples of degree + 1 points are interpolated and checked on all points in parallel threads,
+// the sample with the least median of absolute residuals wins (no threshold is needed),
+// then the polynomial is refitted by least squares on the inliers of the best sample
+// returns nullopt if no sample gives a polynomial
+std::optional<RobustFit> FitRansac(const std::vector<Data>& data, size_t degree, const RobustSettings& settings);
+
+// fits by the method of the settings
+std::optional<RobustFit> FitRobust(const std::vector<Data>& data, size_t degree, const RobustSettings& settings);
+
+// returns points which are inliers
+std::vector<Data> SelectInliers(const std::vector<Data>& data, const std::vector<bool>& inliers);
+// returns indexes of outliers
+std::vector<size_t> GetOutlierIndexes(const std::vector<bool>& inliers);
@@ -1,4 +1,8 @@
 #include "svg.h"
+#include "alloc_tracker.h"
+#include "profiler.h"
+
+#include <optional>
 #include <string_view>
 
 namespace svg {
@@ -101,7 +105,7 @@ void Object::Render(const RenderContext& context) const {
     // Делегируем вывод тега своим подклассам
     RenderObject(context);
 
-    context.out << std::endl;
+    context.out.put('\n');
 }
 
 // ---------- Line --------------------
@@ -223,21 +227,145 @@ void Text::RenderObject(const RenderContext& context) const {
     out << "</text>";
 }
 
+// ------------ Path -------------------
+Path& Path::SetData(std::string data) {
+    data_ = std::move(data);
+    return *this;
+}
+
+void Path::RenderObject(const RenderContext& context) const {
+    auto& out = context.out;
+    out << "<path d=\""sv << data_ << "\" "sv;
+    RenderAttrs(out);
+    out << "/>"sv;
+}
+
+// ------------ Use --------------------
+Use& Use::SetHref(std::string id) {
+    id_ = std::move(id);
+    return *this;
+}
+
+Use& Use::SetPosition(Point pos) {
+    pos_ = pos;
+    return *this;
+}
+
+void Use::RenderObject(const RenderContext& context) const {
+    auto& out = context.out;
+    // href of SVG 2 and xlink:href for SVG 1.1 viewers
+    out << "<use href=\"#"sv << id_ << "\" xlink:href=\"#"sv << id_ << "\" "sv;
+    out << "x=\""sv << pos_.x << "\" y=\""sv << pos_.y << "\"/>"sv;
+}
+
+// ------------ Defs -------------------
+void Defs::RenderObject(const RenderContext& context) const {
+    auto& out = context.out;
+    out << "<defs>"sv << '\n';
+
+    RenderContext group_context = context.Indented();
+    for (const auto& [id, object] : objects_) {
+        group_context.RenderIndent();
+        out << "<g id=\""sv << id << "\">"sv << '\n';
+        object->Render(group_context.Indented());
+        group_context.RenderIndent();
+        out << "</g>"sv << '\n';
+    }
+
+    context.RenderIndent();
+    out << "</defs>"sv;
+}
+
+// ------------ Group ------------------
+Group& Group::SetTranslate(Point offset) {
+    offset_ = offset;
+    return *this;
+}
+
+void Group::AddPtr(std::unique_ptr<Object>&& object) {
+    object->Render(RenderContext{content_, 2});
+}
+
+void Group::RenderObject(const RenderContext& context) const {
+    auto& out = context.out;
+    out << "<g transform=\"translate("sv << offset_.x << ","sv << offset_.y << ")\">"sv << '\n';
+
+    // объекты выведены в буфер без отступа, отступ группы добавляется к каждой строке
+    const RenderContext object_context = context.Indented();
+    std::string_view content = content_.view();
+    while (!content.empty()) {
+        const size_t end = content.find('\n');
+        const size_t line_size = end == std::string_view::npos ? content.size() : end + 1;
+        object_context.RenderIndent();
+        out << content.substr(0, line_size);
+        content.remove_prefix(line_size);
+    }
+    context.RenderIndent();
+    out << "</g>"sv;
+}
+
 // ---------- Document ------------------
 void Document::AddPtr(std::unique_ptr<Object>&& object) {
     objects_.push_back(std::move(object));
 }
 
-void Document::Render(std::ostream& out) const {
+namespace {
+
+void RenderHeader(std::ostream& out, std::optional<Point> size = std::nullopt) {
     out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"sv << std::endl;
-    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv << std::endl;
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" version=\"1.1\""sv;
+    if (size) {
+        out << " width=\""sv << size->x << "\" height=\""sv << size->y
+            << "\" viewBox=\"0 0 "sv << size->x << " "sv << size->y << "\""sv;
+    }
+    out << ">"sv << std::endl;
+}
+
+void RenderFooter(std::ostream& out) {
+    out << "</svg>"sv;
+}
+
+}  // namespace
+
+void Document::Render(std::ostream& out) const {
+    PROFILE_SCOPE("svg::Document::Render");
+    ALLOC_STAGE("render/svg");
+    RenderHeader(out);
 
     RenderContext context{out, 2, 2};
     for(const auto& ob : objects_) {
         ob->Render(context);
     }
 
-    out << "</svg>"sv;
+    RenderFooter(out);
+}
+
+// ---------- StreamDocument ------------
+StreamDocument::StreamDocument(std::ostream& out) : context_{out, 2, 2} {
+    RenderHeader(out);
+}
+
+StreamDocument::StreamDocument(std::ostream& out, double width, double height) : context_{out, 2, 2} {
+    RenderHeader(out, Point{width, height});
+}
+
+StreamDocument::~StreamDocument() {
+    Finish();
+}
+
+void StreamDocument::AddPtr(std::unique_ptr<Object>&& object) {
+    if (finished_) {
+        return;
+    }
+    object->Render(context_);
+}
+
+void StreamDocument::Finish() {
+    if (finished_) {
+        return;
+    }
+    RenderFooter(context_.out);
+    finished_ = true;
 }
 
 }  // namespace svg
\ No newline at end of file
@@ -5,7 +5,8 @@
 #include <memory>
 #include <string>
 #include <optional>
-#include <cstdint>
+#include <sstream>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -156,6 +157,12 @@ public:
         return AsOwner();
     }
 
+    // Задаёт непрозрачность заливки от 0 до 1 (атрибут fill-opacity)
+    Owner& SetFillOpacity(double opacity) {
+        fill_opacity_ = opacity;
+        return AsOwner();
+    }
+
     Owner& SetStrokeColor(Color color) {
         stroke_color_ = std::move(color);
         return AsOwner();
@@ -184,6 +191,7 @@ protected:
         using namespace std::literals;
 
         RenderOptionalAttr(out, "fill"sv, fill_color_);
+        RenderOptionalAttr(out, " fill-opacity"sv, fill_opacity_);
         RenderOptionalAttr(out, " stroke"sv, stroke_color_);
         RenderOptionalAttr(out, " stroke-width"sv, stroke_width_);
         RenderOptionalAttr(out, " stroke-linecap"sv, stroke_line_cap_);
@@ -196,6 +204,7 @@ private:
     }
 
     std::optional<Color> fill_color_;
+    std::optional<double> fill_opacity_;
     std::optional<Color> stroke_color_;
     std::optional<double> stroke_width_;
     std::optional<StrokeLineCap> stroke_line_cap_;
@@ -290,6 +299,59 @@ private:
     std::string text_{};
 };
 
+/*
+ * Класс Path моделирует элемент <path> для отображения произвольного контура
+ * https://developer.mozilla.org/en-US/docs/Web/SVG/Element/path
+ */
+class Path final : public Object, public PathProps<Path> {
+public:
+    // Задаёт команды контура (атрибут d)
+    Path& SetData(std::string data);
+
+private:
+    void RenderObject(const RenderContext& context) const override;
+
+    std::string data_{};
+};
+
+/*
+ * Класс Use моделирует элемент <use> для повторного вывода объекта из <defs>
+ * https://developer.mozilla.org/en-US/docs/Web/SVG/Element/use
+ */
+class Use final : public Object {
+public:
+    // Задаёт id объекта, на который ссылается элемент (атрибуты href и xlink:href)
+    Use& SetHref(std::string id);
+
+    // Задаёт смещение объекта (атрибуты x и y)
+    Use& SetPosition(Point pos);
+
+private:
+    void RenderObject(const RenderContext& context) const override;
+
+    std::string id_{};
+    Point pos_{};
+};
+
+/*
+ * Класс Defs моделирует элемент <defs> с объектами для повторного использования
+ * Каждый объект оборачивается в <g> с заданным id
+ * https://developer.mozilla.org/en-US/docs/Web/SVG/Element/defs
+ */
+class Defs final : public Object {
+public:
+    template <typename Obj>
+    Defs& Add(std::string id, Obj object) {
+        objects_.emplace_back(std::move(id), std::make_unique<Obj>(std::move(object)));
+        return *this;
+    }
+
+private:
+    void RenderObject(const RenderContext& context) const override;
+
+    std::vector<std::pair<std::string, std::unique_ptr<Object>>> objects_;
+};
+
 // Interfaces
 class ObjectContainer {
 public:
@@ -320,4 +382,52 @@ private:
     std::vector<std::unique_ptr<Object>> objects_;
 };
 
+/*
+ * Класс Group моделирует элемент <g> со смещением (атрибут transform)
+ * Объекты выводятся в буфер группы сразу при добавлении, поэтому группы
+ * можно готовить параллельно. Отступы объектов берутся из контекста, в котором выводится группа
+ * https://developer.mozilla.org/en-US/docs/Web/SVG/Element/g
+ */
+class Group final : public Object, public ObjectContainer {
+public:
+    // Задаёт смещение группы (transform="translate(x,y)")
+    Group& SetTranslate(Point offset);
+
+    // Выводит объект в буфер группы
+    void AddPtr(std::unique_ptr<Object>&& obj) override;
+
+private:
+    void RenderObject(const RenderContext& context) const override;
+
+    Point offset_{};
+    std::ostringstream content_;
+};
+
+/*
+ * Класс StreamDocument выводит объекты в ostream сразу при добавлении, не храня их,
+ * поэтому расход памяти не зависит от количества объектов.
+ * Заголовок выводится в конструкторе, закрывающий тег - в Finish() или в деструкторе
+ */
+class StreamDocument : public ObjectContainer {
+public:
+    explicit StreamDocument(std::ostream& out);
+    // Задаёт размер документа (атрибуты width, height и viewBox корневого элемента)
+    StreamDocument(std::ostream& out, double width, double height);
+
+    StreamDocument(const StreamDocument&) = delete;
+    StreamDocument& operator=(const StreamDocument&) = delete;
+
+    ~StreamDocument();
+
+    // Выводит объект в поток и сразу освобождает его
+    void AddPtr(std::unique_ptr<Object>&& obj) override;
+
+    // Завершает svg-документ, последующие объекты игнорируются
+    void Finish();
+
+private:
+    RenderContext context_;
+    bool finished_ = false;
+};
+
 }  // namespace svg
\ No newline at end of file
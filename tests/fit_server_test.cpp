@@ -0,0 +1,152 @@
+// regression test of the socket server: requests which used to crash the server or exhaust its memory
+// are answered with errors, and the server keeps answering other clients
+#include "fit_server.h"
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using namespace std::literals;
+
+namespace {
+
+int failures = 0;
+
+void Check(bool condition, std::string_view message) {
+    if (!condition) {
+        std::cerr << "FAILED: "sv << message << std::endl;
+        ++failures;
+    }
+}
+
+// connects to the socket, the server may not listen yet
+// reading fails after the timeout instead of hanging the test when the server doesn't answer
+int Connect(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::copy(path.begin(), path.end(), address.sun_path);
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        const int client = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (client < 0) {
+            return -1;
+        }
+        if (connect(client, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0) {
+            const timeval timeout{60, 0};
+            setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            return client;
+        }
+        close(client);
+        std::this_thread::sleep_for(50ms);
+    }
+    return -1;
+}
+
+bool SendAll(int socket, std::string_view text) {
+    while (!text.empty()) {
+        const ssize_t written = send(socket, text.data(), text.size(), MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        text.remove_prefix(static_cast<size_t>(written));
+    }
+    return true;
+}
+
+// returns the next answer line without '\n', nullopt if the server closed the connection
+std::optional<std::string> ReadLine(int socket) {
+    std::string line;
+    char symbol;
+    while (true) {
+        const ssize_t size = recv(socket, &symbol, 1, 0);
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size <= 0) {
+            return std::nullopt;
+        }
+        if (symbol == '\n') {
+            return line;
+        }
+        line += symbol;
+    }
+}
+
+bool IsError(const std::optional<std::string>& answer) {
+    return answer && answer->find("\"error\""sv) != std::string::npos;
+}
+
+// deeply nested arrays used to overflow the stack of the parser
+void TestDeepNesting(const std::string& path) {
+    const int client = Connect(path);
+    Check(client >= 0, "connect for deep nesting"sv);
+    Check(SendAll(client, std::string(2'000'000, '[') + '\n'), "send deep nesting"sv);
+    Check(IsError(ReadLine(client)), "deep nesting is answered with an error"sv);
+    close(client);
+}
+
+// a line without '\n' used to be buffered without bound
+void TestTooLongLine(const std::string& path) {
+    const int client = Connect(path);
+    Check(client >= 0, "connect for too long line"sv);
+    Check(SendAll(client, std::string(FitServer::MAX_LINE_LENGTH + 1, ' ')), "send too long line"sv);
+    Check(IsError(ReadLine(client)), "too long line is answered with an error"sv);
+    Check(!ReadLine(client), "connection with too long line is closed"sv);
+    close(client);
+}
+
+void TestFit(const std::string& path) {
+    const int client = Connect(path);
+    Check(client >= 0, "connect for fit"sv);
+    Check(SendAll(client, "{\"command\": \"fit\", \"name\": \"line\", \"degree\": 1, "
+                          "\"data\": [[0, 1], [1, 3], [2, 5]]}\n"sv), "send fit"sv);
+    const std::optional<std::string> answer = ReadLine(client);
+    Check(answer && !IsError(answer), "fit is answered"sv);
+    close(client);
+}
+
+}  // namespace
+
+int main() {
+    const std::string path = "/tmp/approximator_fit_server_test_"s + std::to_string(getpid()) + ".sock"s;
+
+    // the server runs in a child process, so its crash doesn't hide the result of the test
+    const pid_t server = fork();
+    if (server < 0) {
+        std::cerr << "can't start the server"sv << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (server == 0) {
+        FitServer fit_server(renderer::RenderSettings{}, 2, 2);
+        _exit(fit_server.ServeUnixSocket(path) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    TestDeepNesting(path);
+    TestTooLongLine(path);
+    TestFit(path);
+
+    int status = 0;
+    Check(waitpid(server, &status, WNOHANG) == 0, "server is still running"sv);
+    kill(server, SIGTERM);
+    waitpid(server, &status, 0);
+    unlink(path.c_str());
+
+    if (failures == 0) {
+        std::cout << "all tests passed"sv << std::endl;
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,93 @@
+#include "tiled_renderer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace renderer {
+
+namespace {
+// the graph of polynomial is wider than source data by this part on each side
+const double GRAPH_PADDING_RATIO = 0.1;
+// number of points in the graph of polynomial
+const size_t GRAPH_POINTS_COUNT = 1000;
+}  // namespace
+
+TiledRenderer::TiledRenderer(const RenderSettings& settings, size_t columns, size_t threads_count)
+        : renderer_{settings},
+          settings_{settings},
+          columns_{std::max<size_t>(columns, 1)},
+          threads_count_{threads_count ? threads_count : std::max(1u, std::thread::hardware_concurrency())} {
+}
+
+void TiledRenderer::Render(const std::vector<Panel>& panels, std::ostream& out) const {
+    std::vector<svg::Group> groups(panels.size());
+    std::atomic<size_t> next_index{0};
+    // the first exception of the workers is rethrown on the calling thread after all of them are joined
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&]() {
+        try {
+            for (size_t i = next_index++; i < panels.size(); i = next_index++) {
+                groups[i] = RenderPanel(panels[i], i);
+            }
+        } catch (...) {
+            next_index = panels.size();
+            std::lock_guard lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    const size_t threads_count = std::min(threads_count_, panels.size());
+    std::vector<std::thread> threads;
+    threads.reserve(threads_count);
+    for (size_t i = 1; i < threads_count; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    // the document is as large as the whole grid, so viewers show all the panels
+    const size_t rows = (panels.size() + columns_ - 1) / columns_;
+    svg::StreamDocument doc(out, static_cast<double>(columns_) * settings_.width,
+                            static_cast<double>(rows) * settings_.height);
+    for (auto& group : groups) {
+        doc.Add(std::move(group));
+    }
+    doc.Finish();
+}
+
+// builds svg group of the panel with number index
+svg::Group TiledRenderer::RenderPanel(const Panel& panel, size_t index) const {
+    svg::Group group;
+    group.SetTranslate({static_cast<double>(index % columns_) * settings_.width,
+                        static_cast<double>(index / columns_) * settings_.height});
+
+    if (panel.source_points.empty()) {
+        return group;
+    }
+
+    const auto [iter_min, iter_max] = std::minmax_element(panel.source_points.begin(),
+        panel.source_points.end(),
+        [](Data lhs, Data rhs) {
+            return lhs.x < rhs.x;
+    });
+    const double padding = (iter_max->x - iter_min->x) * GRAPH_PADDING_RATIO;
+    const auto result_points = GeneratePoints(panel.polynom, iter_min->x - padding,
+                                              iter_max->x + padding, GRAPH_POINTS_COUNT);
+
+    renderer_.Render(group, panel.source_points, result_points);
+    return group;
+}
+
+}  // namespace renderer
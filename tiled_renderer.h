@@ -0,0 +1,38 @@
+#pragma once
+
+#include "approximator.h"
+#include "graph_renderer.h"
+
+#include <iostream>
+#include <vector>
+
+namespace renderer {
+
+// source data and its approximation drawn on one panel
+struct Panel {
+    std::vector<Data> source_points;
+    Polynomial polynom;
+};
+
+// class renders many graphs into one svg document as a grid of panels
+// every panel is built on a separate thread into its own buffer
+class TiledRenderer {
+public:
+    // settings are used for every panel, width and height are the size of one panel
+    // threads_count = 0 means the number of hardware threads
+    explicit TiledRenderer(const RenderSettings& settings, size_t columns, size_t threads_count = 0);
+
+    // rethrows the first exception thrown while the panels are built, nothing is written then
+    void Render(const std::vector<Panel>& panels, std::ostream& out) const;
+
+private:
+    // builds svg group of the panel with number index
+    svg::Group RenderPanel(const Panel& panel, size_t index) const;
+
+    GraphRenderer renderer_;
+    RenderSettings settings_;
+    size_t columns_;
+    size_t threads_count_;
+};
+
+}  // namespace renderer
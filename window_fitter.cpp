@@ -0,0 +1,153 @@
+#include "window_fitter.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+WindowFitter::WindowFitter(size_t window_size, size_t degree, size_t recenter_interval)
+        : window_size_{std::max(window_size, degree + 1)},
+          degree_{degree},
+          recenter_interval_{recenter_interval ? recenter_interval : window_size_},
+          inverse_(degree + 1, std::vector<double>(degree + 1)),
+          coeffs_(degree + 1),
+          phi_(degree + 1),
+          gain_(degree + 1) {
+}
+
+void WindowFitter::AddSample(Data sample) {
+    window_.push_back(sample);
+    std::optional<Data> removed;
+    if (window_.size() > window_size_) {
+        removed = window_.front();
+        window_.pop_front();
+    }
+
+    ++samples_since_rebuild_;
+    if (!valid_ || samples_since_rebuild_ >= recenter_interval_) {
+        Rebuild();
+        return;
+    }
+    if ((removed && !Update(*removed, -1)) || !Update(sample, 1)) {
+        Rebuild();
+    }
+}
+
+void WindowFitter::FillPowers(double x) {
+    const double t = (x - center_) / scale_;
+    double t_power = 1;
+    for (double& value : phi_) {
+        value = t_power;
+        t_power *= t;
+    }
+}
+
+// P = P - sign * P * phi * phi^T * P / (1 + sign * phi^T * P * phi)
+// coeffs = coeffs + sign * P_new * phi * (y - phi^T * coeffs)
+bool WindowFitter::Update(Data point, double sign) {
+    const size_t size = degree_ + 1;
+    FillPowers(point.x);
+
+    // gain = P * phi, P is symmetric
+    double denominator = 1;
+    for (size_t i = 0; i < size; ++i) {
+        double value = 0;
+        for (size_t j = 0; j < size; ++j) {
+            value += inverse_[i][j] * phi_[j];
+        }
+        gain_[i] = value;
+        denominator += sign * phi_[i] * value;
+    }
+    // removal of the point which carries all information of some direction
+    if (!(denominator > std::numeric_limits<double>::epsilon())) {
+        return false;
+    }
+
+    double error = point.y;
+    for (size_t i = 0; i < size; ++i) {
+        error -= phi_[i] * coeffs_[i];
+    }
+
+    for (size_t i = 0; i < size; ++i) {
+        for (size_t j = 0; j < size; ++j) {
+            inverse_[i][j] -= sign * gain_[i] * gain_[j] / denominator;
+        }
+        // P_new * phi = gain / denominator
+        coeffs_[i] += sign * gain_[i] / denominator * error;
+    }
+    return true;
+}
+
+void WindowFitter::Rebuild() {
+    PROFILE_SCOPE("WindowFitter::Rebuild");
+    samples_since_rebuild_ = 0;
+    valid_ = false;
+    if (window_.size() <= degree_) {
+        return;
+    }
+
+    const auto [iter_min, iter_max] = std::minmax_element(window_.begin(), window_.end(),
+        [](Data lhs, Data rhs) {
+            return lhs.x < rhs.x;
+    });
+    center_ = (iter_min->x + iter_max->x) / 2;
+    scale_ = (iter_max->x - iter_min->x) / 2;
+    if (scale_ == 0) {
+        scale_ = 1;
+    }
+
+    const size_t size = degree_ + 1;
+    BasicMatrix<double> matrix(size, std::vector<double>(size));
+    std::vector<double> right_part(size);
+    for (const Data& point : window_) {
+        FillPowers(point.x);
+        for (size_t i = 0; i < size; ++i) {
+            for (size_t j = 0; j < size; ++j) {
+                matrix[i][j] += phi_[i] * phi_[j];
+            }
+            right_part[i] += phi_[i] * point.y;
+        }
+    }
+
+    const auto lu = LuFactorization<double>::Factor(std::move(matrix));
+    if (!lu) {
+        return;
+    }
+    inverse_ = lu->GetInverse();
+    coeffs_ = lu->Solve(std::move(right_part));
+    valid_ = true;
+}
+
+std::optional<Polynomial> WindowFitter::GetPolynom() const {
+    if (!valid_) {
+        return std::nullopt;
+    }
+    // t = (x - center) / scale, (x - center)^j is expanded by the binomial formula
+    const size_t size = degree_ + 1;
+    std::vector<double> coeffs(size);
+    double scale_power = 1;  // 1 / scale^j
+    for (size_t j = 0; j < size; ++j) {
+        double binomial = 1;  // C(j, l)
+        double center_power = 1;  // (-center)^(j - l)
+        for (size_t l = j + 1; l-- > 0;) {
+            coeffs[l] += coeffs_[j] * scale_power * binomial * center_power;
+            binomial = binomial * static_cast<double>(l) / static_cast<double>(j - l + 1);
+            center_power *= -center_;
+        }
+        scale_power /= scale_;
+    }
+    return Polynomial(std::move(coeffs));
+}
+
+std::optional<double> WindowFitter::Evaluate(double x) const {
+    if (!valid_) {
+        return std::nullopt;
+    }
+    // Horner's method in the centred variable
+    const double t = (x - center_) / scale_;
+    double res = 0;
+    for (size_t i = coeffs_.size(); i-- > 0;) {
+        res = res * t + coeffs_[i];
+    }
+    return res;
+}
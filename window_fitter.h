@@ -0,0 +1,60 @@
+#pragma once
+
+#include "approximator.h"
+
+#include <deque>
+#include <optional>
+#include <vector>
+
+// fits the polynomial to the last window_size samples of a stream
+// x is centred and scaled to t = (x - center) / scale over the window, the fitter keeps
+// the inverse matrix P = (sum(phi * phi^T))^-1 and coefficients in powers of t, phi = (1, t, ..., t^n)
+// every sample adds the contribution of the newest point and subtracts the one of the oldest point
+// by rank one updates of P (recursive least squares), each costs O(n^2) independently of the window size
+// every recenter_interval samples the centre moves to the middle of the window
+// and the system is rebuilt from the window, it removes rounding errors accumulated by the updates
+class WindowFitter {
+public:
+    // recenter_interval = 0 means window_size
+    WindowFitter(size_t window_size, size_t degree, size_t recenter_interval = 0);
+
+    // adds the sample to the window, the oldest sample leaves the full window
+    void AddSample(Data sample);
+
+    // returns the number of samples in the window
+    size_t GetSamplesCount() const {
+        return window_.size();
+    }
+
+    // returns the polynomial in powers of x
+    // returns nullopt while the window has not more samples than the degree or the points are degenerate
+    std::optional<Polynomial> GetPolynom() const;
+
+    // evaluates the fit in the centred variable, which is more accurate than GetPolynom far from zero
+    std::optional<double> Evaluate(double x) const;
+
+private:
+    // fills phi_ with powers of the centred x
+    void FillPowers(double x);
+    // adds (sign = 1) or removes (sign = -1) the point, returns false if the update is degenerate
+    bool Update(Data point, double sign);
+    // moves the centre to the middle of the window and solves the system built from the window
+    void Rebuild();
+
+    size_t window_size_;
+    size_t degree_;
+    size_t recenter_interval_;
+    size_t samples_since_rebuild_ = 0;
+
+    std::deque<Data> window_;
+    double center_ = 0;
+    double scale_ = 1;
+
+    bool valid_ = false;  // inverse_ and coeffs_ hold the fit of the window
+    BasicMatrix<double> inverse_;
+    std::vector<double> coeffs_;  // coefficients in powers of t
+
+    // buffers of the update
+    std::vector<double> phi_;
+    std::vector<double> gain_;
+};